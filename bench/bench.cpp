@@ -0,0 +1,512 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <giomm/init.h>
+#include <glibmm/init.h>
+
+#include <nil/crypto3/algebra/fields/vesta/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/vesta.hpp>
+#include <nil/crypto3/algebra/curves/vesta.hpp>
+#include <nil/crypto3/algebra/fields/pallas/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/pallas.hpp>
+#include <nil/crypto3/algebra/curves/pallas.hpp>
+
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt6/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/goldilocks64.hpp>
+#include <nil/crypto3/algebra/curves/alt_bn128.hpp>
+
+#include "nil/crypto3/algebra/fields/alt_bn128/scalar_field.hpp"
+#include "generator.hpp"
+#include "table.hpp"
+
+// Benchmark arguments are passed positionally, these are the meanings of the state.range(i) values.
+// Table benchmarks: rows, witness columns. Circuit benchmarks: rows, gates, degree.
+// Tables and circuits come from synthetic_generator, see generator.hpp for their shape.
+
+using vesta_field_type = nil::crypto3::algebra::curves::vesta::base_field_type;
+using pallas_field_type = nil::crypto3::algebra::curves::pallas::base_field_type;
+using bls12_fr_381_field_type = nil::crypto3::algebra::fields::bls12_fr<381>;
+using bls12_fq_381_field_type = nil::crypto3::algebra::fields::bls12_fq<381>;
+using mnt4_field_type = nil::crypto3::algebra::fields::mnt4_fq<298>;
+using mnt6_field_type = nil::crypto3::algebra::fields::mnt6_fq<298>;
+using goldilocks64_field_type = nil::crypto3::algebra::fields::goldilocks64;
+using bn_base_field_type = nil::crypto3::algebra::fields::alt_bn128<254>;
+using bn_scalar_field_type = nil::crypto3::algebra::fields::alt_bn128_scalar_field<254>;
+
+generator_params make_params(std::size_t rows, std::size_t witnesses, std::size_t gates, std::size_t degree) {
+    generator_params params;
+    params.sizes.witnesses_size = witnesses;
+    params.sizes.public_inputs_size = 1;
+    params.sizes.constants_size = 1;
+    params.sizes.selectors_size = gates;
+    params.sizes.max_size = rows;
+    params.degree = degree;
+    params.copy_constraints_size = rows / 16;
+    return params;
+}
+
+template<typename BlueprintFieldType>
+using parsed_rows = std::vector<std::vector<typename field_traits<BlueprintFieldType>::parsed_type>>;
+
+template<typename BlueprintFieldType>
+parsed_rows<BlueprintFieldType> make_parsed_rows(const synthetic_generator<BlueprintFieldType> &generator) {
+    const table_sizes &sizes = generator.get_params().sizes;
+    table_row_parser<std::string::iterator, BlueprintFieldType> row_parser(sizes);
+    parsed_rows<BlueprintFieldType> rows(sizes.max_size);
+    std::string line;
+    for (std::size_t i = 0; i < sizes.max_size; i++) {
+        line.clear();
+        generator.append_table_row(line, i);
+        auto line_begin = line.begin();
+        boost::spirit::qi::phrase_parse(line_begin, line.end(), row_parser, boost::spirit::ascii::space, rows[i]);
+    }
+    return rows;
+}
+
+template<typename BlueprintFieldType>
+std::shared_ptr<table_store<BlueprintFieldType>> make_table_store(
+        const table_sizes &sizes, const parsed_rows<BlueprintFieldType> &rows) {
+    auto store = std::make_shared<table_store<BlueprintFieldType>>(sizes);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        store->set_row(i, rows[i]);
+    }
+    return store;
+}
+
+template<typename BlueprintFieldType>
+void make_circuit(circuit_container<BlueprintFieldType> &circuit,
+                  const synthetic_generator<BlueprintFieldType> &generator) {
+    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
+    using plonk_gate_type = nil::crypto3::zk::snark::plonk_gate<BlueprintFieldType, plonk_constraint_type>;
+    using plonk_copy_constraint_type = nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType>;
+
+    const generator_params &params = generator.get_params();
+    gate_constraint_parser<std::string::iterator, BlueprintFieldType> constraint_parser;
+    copy_constraint_parser<std::string::iterator, BlueprintFieldType> copy_parser;
+    circuit.sizes.gates_size = params.sizes.selectors_size;
+    circuit.sizes.copy_constraints_size = generator.get_copy_constraints_size();
+    circuit.sizes.lookup_gates_size = 0;
+    std::string line;
+    for (std::size_t i = 0; i < params.sizes.selectors_size; i++) {
+        std::vector<plonk_constraint_type> constraints;
+        for (std::size_t j = 0; j < params.constraints_per_gate; j++) {
+            line.clear();
+            generator.append_constraint(line, i, j);
+            auto line_begin = line.begin();
+            plonk_constraint_type constraint;
+            boost::spirit::qi::phrase_parse(line_begin, line.end(), constraint_parser,
+                                            boost::spirit::ascii::space, constraint);
+            constraints.push_back(constraint);
+        }
+        circuit.gates.emplace_back(plonk_gate_type(i, constraints));
+    }
+    for (std::size_t i = 0; i < circuit.sizes.copy_constraints_size; i++) {
+        line.clear();
+        generator.append_copy_constraint(line, i);
+        auto line_begin = line.begin();
+        plonk_copy_constraint_type constraint;
+        boost::spirit::qi::phrase_parse(line_begin, line.end(), copy_parser, boost::spirit::ascii::space, constraint);
+        circuit.copy_constraints.push_back(constraint);
+    }
+}
+
+template<typename BlueprintFieldType>
+static void BM_table_row_parser(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 2));
+    const table_sizes &sizes = generator.get_params().sizes;
+    std::vector<std::string> lines(sizes.max_size);
+    for (std::size_t i = 0; i < sizes.max_size; i++) {
+        generator.append_table_row(lines[i], i);
+    }
+    table_row_parser<std::string::iterator, BlueprintFieldType> row_parser(sizes);
+    for (auto _ : state) {
+        for (auto &line : lines) {
+            auto line_begin = line.begin();
+            std::vector<typename field_traits<BlueprintFieldType>::parsed_type> row;
+            bool r = boost::spirit::qi::phrase_parse(line_begin, line.end(), row_parser,
+                                                     boost::spirit::ascii::space, row);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sizes.max_size);
+}
+
+// Whole table text read through pipelined_table_reader, the third argument is the amount of parser threads.
+template<typename BlueprintFieldType>
+static void BM_pipelined_table_read(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 2));
+    const table_sizes &sizes = generator.get_params().sizes;
+    std::string text;
+    generator.append_table_header(text);
+    for (std::size_t i = 0; i < sizes.max_size; i++) {
+        generator.append_table_row(text, i);
+    }
+    pipelined_table_reader<BlueprintFieldType> reader(state.range(2));
+    for (auto _ : state) {
+        std::size_t position = 0;
+        auto store = reader.read([&](char* data, std::size_t size) {
+            size = std::min(size, text.size() - position);
+            std::memcpy(data, text.data() + position, size);
+            position += size;
+            return size;
+        });
+        benchmark::DoNotOptimize(store.get());
+    }
+    state.SetItemsProcessed(state.iterations() * sizes.max_size);
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+template<typename BlueprintFieldType>
+static void BM_gate_constraint_parser(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(16, state.range(1), 64, state.range(2)));
+    const generator_params &params = generator.get_params();
+    std::vector<std::string> lines;
+    for (std::size_t i = 0; i < params.sizes.selectors_size; i++) {
+        for (std::size_t j = 0; j < params.constraints_per_gate; j++) {
+            lines.emplace_back();
+            generator.append_constraint(lines.back(), i, j);
+        }
+    }
+    gate_constraint_parser<std::string::iterator, BlueprintFieldType> constraint_parser;
+    for (auto _ : state) {
+        for (auto &line : lines) {
+            auto line_begin = line.begin();
+            nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType> constraint;
+            bool r = boost::spirit::qi::phrase_parse(line_begin, line.end(), constraint_parser,
+                                                     boost::spirit::ascii::space, constraint);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+}
+
+template<typename BlueprintFieldType>
+static void BM_copy_constraint_parser(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 2));
+    std::vector<std::string> lines(generator.get_copy_constraints_size());
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        generator.append_copy_constraint(lines[i], i);
+    }
+    copy_constraint_parser<std::string::iterator, BlueprintFieldType> constraint_parser;
+    for (auto _ : state) {
+        for (auto &line : lines) {
+            auto line_begin = line.begin();
+            nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType> constraint;
+            bool r = boost::spirit::qi::phrase_parse(line_begin, line.end(), constraint_parser,
+                                                     boost::spirit::ascii::space, constraint);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+}
+
+template<typename BlueprintFieldType>
+static void BM_row_store_construction(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 2));
+    auto rows = make_parsed_rows(generator);
+    for (auto _ : state) {
+        auto store = make_table_store<BlueprintFieldType>(generator.get_params().sizes, rows);
+        auto rows_model = row_model<BlueprintFieldType>::create(store);
+        // About a screen of rows, the view never asks for more at once.
+        for (guint i = 0; i < 64 && i < rows_model->get_n_items(); i++) {
+            benchmark::DoNotOptimize(rows_model->get_object(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+
+template<typename BlueprintFieldType>
+static void BM_gate_cache_building(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    constraint_index<BlueprintFieldType> index;
+    for (auto _ : state) {
+        index.build(*store, circuit);
+        benchmark::DoNotOptimize(index.get_gate_entries_size());
+    }
+    state.SetItemsProcessed(state.iterations() * sizes.max_size);
+}
+
+template<typename BlueprintFieldType>
+static void BM_constraint_evaluation(benchmark::State &state) {
+    using var = nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>;
+
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    std::size_t evaluations = 0;
+    for (auto _ : state) {
+        evaluations = 0;
+        for (std::size_t row = 0; row < sizes.max_size; row++) {
+            std::size_t gate = generator.enabled_gate(row);
+            if (gate == circuit.gates.size()) {
+                continue;
+            }
+            for (auto &constraint : circuit.gates[gate].constraints) {
+                std::set<var> variable_set;
+                auto value = evaluate_constraint<BlueprintFieldType>(*store, constraint, row, variable_set);
+                benchmark::DoNotOptimize(value);
+                evaluations++;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * evaluations);
+}
+
+template<typename BlueprintFieldType>
+static void BM_dag_evaluation(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    expression_dag<BlueprintFieldType> dag;
+    dag.build(circuit);
+    typename expression_dag<BlueprintFieldType>::row_context context;
+    std::size_t evaluations = 0;
+    for (auto _ : state) {
+        evaluations = 0;
+        for (std::size_t row = 0; row < sizes.max_size; row++) {
+            std::size_t gate = generator.enabled_gate(row);
+            if (gate == circuit.gates.size()) {
+                continue;
+            }
+            dag.begin_row(context, row);
+            for (std::size_t j = 0; j < circuit.gates[gate].constraints.size(); j++) {
+                benchmark::DoNotOptimize(dag.evaluate(*store, context, gate, j));
+                evaluations++;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * evaluations);
+    state.counters["nodes"] = dag.get_nodes_size();
+    state.counters["tree_nodes"] = dag.get_tree_nodes_size();
+}
+
+template<typename BlueprintFieldType>
+static void BM_gate_evaluation(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    expression_dag<BlueprintFieldType> dag;
+    dag.build(circuit);
+    gate_evaluator<BlueprintFieldType> evaluator;
+    evaluator.build(dag, circuit);
+    std::size_t evaluations = 0;
+    for (auto _ : state) {
+        auto result = evaluator.check(*store);
+        evaluations = result.evaluations;
+        benchmark::DoNotOptimize(result.failures.data());
+    }
+    state.SetItemsProcessed(state.iterations() * evaluations);
+}
+
+// Same as BM_gate_evaluation, with the table paged in from a file. The fourth argument is the amount of pages
+// kept in memory.
+template<typename BlueprintFieldType>
+static void BM_paged_gate_evaluation(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    const std::string path = std::filesystem::temp_directory_path() / "excalibur-bench-table.txt";
+    {
+        buffered_writer writer(path);
+        generator.write_table(writer);
+    }
+    auto source = std::make_shared<text_page_source<BlueprintFieldType>>(path);
+    table_store<BlueprintFieldType> store(source->get_sizes());
+    auto selector_bitmaps = source->take_selector_bitmaps();
+    for (std::size_t i = 0; i < selector_bitmaps.size(); i++) {
+        store.set_selector_bitmap(i, std::move(selector_bitmaps[i]));
+    }
+    store.set_page_source(source, state.range(3));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    expression_dag<BlueprintFieldType> dag;
+    dag.build(circuit);
+    gate_evaluator<BlueprintFieldType> evaluator;
+    evaluator.build(dag, circuit);
+    std::size_t evaluations = 0;
+    for (auto _ : state) {
+        auto result = evaluator.check(store);
+        evaluations = result.evaluations;
+        benchmark::DoNotOptimize(result.failures.data());
+    }
+    state.SetItemsProcessed(state.iterations() * evaluations);
+    std::filesystem::remove(path);
+}
+
+// Opening a session snapshot of a table with a circuit, versus parsing both and building the caches.
+template<typename BlueprintFieldType>
+static void BM_session_snapshot_load(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(
+        make_params(state.range(0), 16, state.range(1), state.range(2)));
+    table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    circuit_container<BlueprintFieldType> circuit;
+    make_circuit(circuit, generator);
+    constraint_index<BlueprintFieldType> index;
+    index.build(*store, circuit);
+    expression_dag<BlueprintFieldType> dag;
+    dag.build(circuit);
+    const std::string path = std::filesystem::temp_directory_path() / "excalibur-bench-session.snap";
+    save_session_snapshot(path, *store, circuit, dag, index, nullptr, snapshot_source(), snapshot_source());
+    for (auto _ : state) {
+        session_snapshot<BlueprintFieldType> session;
+        load_session_snapshot(path, session);
+        benchmark::DoNotOptimize(session.store.get());
+    }
+    state.SetItemsProcessed(state.iterations() * sizes.max_size);
+    state.counters["bytes"] = std::filesystem::file_size(path);
+    std::filesystem::remove(path);
+}
+
+// Reading a watched table file again after a change which left every row block as it was.
+template<typename BlueprintFieldType>
+static void BM_watched_table_reload(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 3));
+    const std::string path = std::filesystem::temp_directory_path() / "excalibur-bench-watched.txt";
+    {
+        buffered_writer writer(path);
+        generator.write_table(writer);
+    }
+    auto store = make_table_store<BlueprintFieldType>(generator.get_params().sizes, make_parsed_rows(generator));
+    watched_table_file<BlueprintFieldType> watched(path);
+    for (auto _ : state) {
+        auto result = watched.reload(*store);
+        benchmark::DoNotOptimize(result.changed_blocks.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove(path);
+}
+
+// Loading the last 1024 rows of a table file, of all the columns if the third argument is 0 and of four witness
+// columns otherwise. The row index is kept between the iterations, as it is between runs of the viewer.
+template<typename BlueprintFieldType>
+static void BM_table_window_read(benchmark::State &state) {
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 3));
+    const std::string path = std::filesystem::temp_directory_path() / "excalibur-bench-window.txt";
+    const std::string index_directory = std::filesystem::temp_directory_path() / "excalibur-bench-rows";
+    {
+        buffered_writer writer(path);
+        generator.write_table(writer);
+    }
+    const std::size_t window_rows = 1024;
+    table_window_reader<BlueprintFieldType> reader(4, index_directory);
+    for (auto _ : state) {
+        auto store = reader.read(path, state.range(0) - window_rows, window_rows, state.range(2) == 0 ? "" : "W0..W3");
+        benchmark::DoNotOptimize(store->get_cell(0, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * window_rows);
+    std::filesystem::remove(path);
+    std::filesystem::remove_all(index_directory);
+}
+
+// Opening a table handed over in shared memory and reading all of it, to compare with BM_pipelined_table_read.
+template<typename BlueprintFieldType>
+static void BM_shared_table_read(benchmark::State &state) {
+    using traits = field_traits<BlueprintFieldType>;
+    synthetic_generator<BlueprintFieldType> generator(make_params(state.range(0), state.range(1), 4, 2));
+    const table_sizes sizes = generator.get_params().sizes;
+    auto store = make_table_store<BlueprintFieldType>(sizes, make_parsed_rows(generator));
+    const std::string name = "/excalibur-bench-table";
+    shared_table_writer<BlueprintFieldType> writer(name, sizes);
+    for (std::size_t column = 0; column < store->get_columns_amount(); column++) {
+        for (std::size_t row = 0; row < sizes.max_size; row++) {
+            writer.set(column, row, store->get_cell(column, row));
+        }
+    }
+    writer.publish();
+    for (auto _ : state) {
+        auto source = std::make_shared<shared_page_source<BlueprintFieldType>>(name);
+        table_store<BlueprintFieldType> shared_store(source->get_sizes());
+        auto selector_bitmaps = source->get_selector_bitmaps();
+        for (std::size_t i = 0; i < selector_bitmaps.size(); i++) {
+            shared_store.set_selector_bitmap(i, std::move(selector_bitmaps[i]));
+        }
+        shared_store.set_page_source(source, source->get_pages_amount());
+        for (std::size_t row = 0; row < sizes.max_size; row += table_store<BlueprintFieldType>::block_rows) {
+            benchmark::DoNotOptimize(traits::is_zero(shared_store.get_cell(0, row)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sizes.max_size);
+    shared_table_writer<BlueprintFieldType>::unlink(name);
+}
+
+#define EXCALIBUR_FIELD_BENCHMARKS(field_type)                                                       \
+    BENCHMARK_TEMPLATE(BM_table_row_parser, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {15, 150}}); \
+    BENCHMARK_TEMPLATE(BM_pipelined_table_read, field_type)->ArgsProduct({{1 << 14}, {15, 150}, {1, 4}}); \
+    BENCHMARK_TEMPLATE(BM_gate_constraint_parser, field_type)->ArgsProduct({{0}, {15, 150}, {1, 3, 8}}); \
+    BENCHMARK_TEMPLATE(BM_copy_constraint_parser, field_type)->ArgsProduct({{1 << 14}, {15, 150}});   \
+    BENCHMARK_TEMPLATE(BM_row_store_construction, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {15, 150}}); \
+    BENCHMARK_TEMPLATE(BM_gate_cache_building, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {4, 32}, {3}}); \
+    BENCHMARK_TEMPLATE(BM_constraint_evaluation, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {4, 32}, {1, 3, 8}}); \
+    BENCHMARK_TEMPLATE(BM_dag_evaluation, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {4, 32}, {1, 3, 8}}); \
+    BENCHMARK_TEMPLATE(BM_gate_evaluation, field_type)->ArgsProduct({{1 << 10, 1 << 14}, {4, 32}, {1, 3, 8}}); \
+    BENCHMARK_TEMPLATE(BM_paged_gate_evaluation, field_type)->ArgsProduct({{1 << 14}, {4}, {3}, {2, 16}}); \
+    BENCHMARK_TEMPLATE(BM_session_snapshot_load, field_type)->ArgsProduct({{1 << 14}, {4, 32}, {3}}); \
+    BENCHMARK_TEMPLATE(BM_watched_table_reload, field_type)->ArgsProduct({{1 << 14}, {15, 150}}); \
+    BENCHMARK_TEMPLATE(BM_shared_table_read, field_type)->ArgsProduct({{1 << 14}, {15, 150}}); \
+    BENCHMARK_TEMPLATE(BM_table_window_read, field_type)->ArgsProduct({{1 << 18}, {15, 150}, {0, 1}})
+
+EXCALIBUR_FIELD_BENCHMARKS(vesta_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(pallas_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(bls12_fr_381_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(bls12_fq_381_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(mnt4_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(mnt6_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(goldilocks64_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(bn_base_field_type);
+EXCALIBUR_FIELD_BENCHMARKS(bn_scalar_field_type);
+
+int main(int argc, char* argv[]) {
+    // row_object is a Glib::Object, and row_model is a Gio::ListModel, so both type systems have to be up.
+    Glib::init();
+    Gio::init();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
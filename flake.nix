@@ -34,6 +34,8 @@
               glib
               pango
               pangomm
+              zlib
+              zstd
               crypto3
             ];
 
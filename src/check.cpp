@@ -0,0 +1,236 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <glibmm/init.h>
+#include <glibmm/optioncontext.h>
+#include <glibmm/optiongroup.h>
+
+#include <nil/crypto3/algebra/fields/vesta/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/vesta.hpp>
+#include <nil/crypto3/algebra/curves/vesta.hpp>
+#include <nil/crypto3/algebra/fields/pallas/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/pallas.hpp>
+#include <nil/crypto3/algebra/curves/pallas.hpp>
+
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt6/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/goldilocks64.hpp>
+#include <nil/crypto3/algebra/curves/alt_bn128.hpp>
+
+#include "nil/crypto3/algebra/fields/alt_bn128/scalar_field.hpp"
+#include "core.hpp"
+
+struct check_params {
+    std::string table_path;
+    std::string circuit_path;
+    // Results are not kept between runs if it is empty.
+    std::string result_cache_dir;
+    // Only this part of the table is checked if either is set, see table_window.hpp.
+    std::string window_rows;
+    std::string window_columns;
+    std::size_t max_failures;
+};
+
+// Checks a table against a circuit without the viewer. Returns 0 if every constraint holds, 1 if some fail
+// and 2 if the files can not be read or do not fit together.
+template<typename BlueprintFieldType>
+int check(const check_params &params) {
+    using check_result_type = typename gate_evaluator<BlueprintFieldType>::check_result;
+
+    circuit_container<BlueprintFieldType> circuit;
+    expression_dag<BlueprintFieldType> dag;
+    gate_evaluator<BlueprintFieldType> evaluator;
+    check_result_type result;
+    std::size_t first_row = 0;
+    bool partial = false;
+    try {
+        std::shared_ptr<table_store<BlueprintFieldType>> store;
+        if (params.window_rows.empty() && params.window_columns.empty()) {
+            store = load_table_file<BlueprintFieldType>(params.table_path);
+        } else {
+            std::size_t rows_amount = 0;
+            if (!params.window_rows.empty() && !parse_row_range(params.window_rows, first_row, rows_amount)) {
+                throw std::runtime_error("--rows has to be a row or a range of rows such as 1000..4999");
+            }
+            table_window_reader<BlueprintFieldType> reader(std::max(1u, std::thread::hardware_concurrency()),
+                                                           params.result_cache_dir);
+            store = reader.read(params.table_path, first_row, rows_amount, params.window_columns);
+            partial = !store->get_window().is_whole();
+        }
+        load_circuit_file(params.circuit_path, circuit);
+        validate_circuit(circuit, store->get_sizes());
+        dag.build(circuit);
+        evaluator.build(dag, circuit);
+        // Results for a part of a table are not kept, they would replace those for the whole one.
+        if (params.result_cache_dir.empty() || partial) {
+            result = evaluator.check(*store);
+        } else {
+            std::vector<cached_row_block> blocks;
+            cached_check_stats stats;
+            result = cached_check(params.result_cache_dir, get_circuit_hash(circuit, dag), evaluator, *store,
+                                  blocks, stats);
+            std::cerr << "Reused earlier results for " << stats.reused_row_blocks << " of " << stats.row_blocks
+                      << " row blocks" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+
+    for (std::size_t i = 0; i < result.failures.size() && i < params.max_failures; i++) {
+        const auto &failure = result.failures[i];
+        std::cout << "gate " << failure.gate << " (selector " << circuit.gates[failure.gate].selector_index
+                  << ") constraint " << failure.constraint_num << " fails at row " << first_row + failure.row
+                  << std::endl;
+    }
+    if (result.failures.size() > params.max_failures) {
+        std::cout << result.failures.size() - params.max_failures << " more failures" << std::endl;
+    }
+    std::cerr << "Checked " << result.evaluations << " constraint evaluations, " << result.failures.size()
+              << " failed" << std::endl;
+    if (result.out_of_table_rows != 0) {
+        std::cerr << result.out_of_table_rows << " enabled gate rows refer to cells outside of the "
+                  << (partial ? "loaded part of the " : "") << "table and were skipped" << std::endl;
+    }
+    return result.failures.empty() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    Glib::init();
+
+    using vesta_curve_type = nil::crypto3::algebra::curves::vesta::base_field_type;
+    using pallas_curve_type = nil::crypto3::algebra::curves::pallas::base_field_type;
+    using bls12_fr_381_curve_type = nil::crypto3::algebra::fields::bls12_fr<381>;
+    using bls12_fq_381_curve_type = nil::crypto3::algebra::fields::bls12_fq<381>;
+    using mnt4_curve_type = nil::crypto3::algebra::fields::mnt4_fq<298>;
+    using mnt6_curve_type = nil::crypto3::algebra::fields::mnt6_fq<298>;
+    using goldilocks64_field_type = nil::crypto3::algebra::fields::goldilocks64;
+    using bn_base_field_type = nil::crypto3::algebra::fields::alt_bn128<254>;
+    using bn_scalar_field_type = nil::crypto3::algebra::fields::alt_bn128_scalar_field<254>;
+
+    Glib::OptionGroup main_group("curves", "Curves", "Curve used in the program");
+
+    bool vesta = false, pallas = false, bls12_fr_381 = false, bls12_fq_381 = false,
+         mnt4 = false, mnt6 = false, goldilocks64 = false, bn_base = false, bn_scalar = false;
+    std::vector<std::tuple<const char*, char, const char*, bool*>> curve_entries = {
+        {"vesta", 'v', "Use Vesta curve", &vesta},
+        {"pallas", 'p', "Use Pallas curve", &pallas},
+        {"bls12_fr_381", 'b', "Use BLS12_fr_381 curve", &bls12_fr_381},
+        {"bls12_fq_381", 'q', "Use BLS12_fq_381 curve", &bls12_fq_381},
+        {"mnt4", '4', "Use mnt4 curve", &mnt4},
+        {"mnt6", '6', "Use mnt6 curve", &mnt6},
+        {"goldilocks64", 'g', "Use Goldilocks64 curve", &goldilocks64},
+        {"bn", 'n', "Use BN curve base field", &bn_base},
+        {"bn_scalar", 's', "Use BN curve scalar field", &bn_scalar}};
+    for (auto &[long_name, short_name, description, flag] : curve_entries) {
+        Glib::OptionEntry entry;
+        entry.set_long_name(long_name);
+        entry.set_short_name(short_name);
+        entry.set_description(description);
+        main_group.add_entry(entry, *flag);
+    }
+
+    Glib::OptionGroup files_group("files", "Files", "Checked files");
+    check_params params;
+    Glib::ustring window_rows, window_columns;
+    int max_failures = 100;
+    Glib::OptionEntry table_entry, circuit_entry, result_cache_entry, window_rows_entry, window_columns_entry,
+                      max_failures_entry;
+    table_entry.set_long_name("table");
+    table_entry.set_description("Table file, may be compressed");
+    files_group.add_entry_filename(table_entry, params.table_path);
+    circuit_entry.set_long_name("circuit");
+    circuit_entry.set_description("Circuit file, may be compressed");
+    files_group.add_entry_filename(circuit_entry, params.circuit_path);
+    result_cache_entry.set_long_name("result_cache");
+    result_cache_entry.set_description("Keep check results in this directory and only check changed rows again");
+    files_group.add_entry_filename(result_cache_entry, params.result_cache_dir);
+    window_rows_entry.set_long_name("rows");
+    window_rows_entry.set_description("Only check these rows of the table, as in 1000..4999");
+    files_group.add_entry(window_rows_entry, window_rows);
+    window_columns_entry.set_long_name("columns");
+    window_columns_entry.set_description("Only load these columns, gates reading other ones are skipped");
+    files_group.add_entry(window_columns_entry, window_columns);
+    max_failures_entry.set_long_name("max_failures");
+    max_failures_entry.set_description("Amount of failed constraints to list");
+    files_group.add_entry(max_failures_entry, max_failures);
+
+    Glib::OptionContext context;
+    context.set_main_group(main_group);
+    context.add_group(files_group);
+    context.set_help_enabled(true);
+    context.parse(argc, argv);
+
+    std::vector<bool> curve_selections = {
+        vesta, pallas, bls12_fr_381, bls12_fq_381, mnt4, mnt6, goldilocks64, bn_base, bn_scalar};
+    uint8_t curve_count = std::accumulate(curve_selections.begin(), curve_selections.end(), 0);
+    if (curve_count != 1) {
+        std::cerr << "Error: exactly one curve has to be selected." << std::endl;
+        return 2;
+    }
+    if (params.table_path.empty() || params.circuit_path.empty()) {
+        std::cerr << "Error: both --table and --circuit have to be given." << std::endl;
+        return 2;
+    }
+    if (max_failures < 0) {
+        std::cerr << "Error: --max_failures can not be negative." << std::endl;
+        return 2;
+    }
+    params.window_rows = window_rows;
+    params.window_columns = window_columns;
+    params.max_failures = max_failures;
+
+    if (vesta) {
+        return check<vesta_curve_type>(params);
+    }
+    if (pallas) {
+        return check<pallas_curve_type>(params);
+    }
+    if (bls12_fr_381) {
+        return check<bls12_fr_381_curve_type>(params);
+    }
+    if (bls12_fq_381) {
+        return check<bls12_fq_381_curve_type>(params);
+    }
+    if (mnt4) {
+        return check<mnt4_curve_type>(params);
+    }
+    if (mnt6) {
+        return check<mnt6_curve_type>(params);
+    }
+    if (goldilocks64) {
+        return check<goldilocks64_field_type>(params);
+    }
+    if (bn_base) {
+        return check<bn_base_field_type>(params);
+    }
+    if (bn_scalar) {
+        return check<bn_scalar_field_type>(params);
+    }
+}
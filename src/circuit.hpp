@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include <nil/crypto3/zk/snark/arithmetization/plonk/gate.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/copy_constraint.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/constraint.hpp>
+#include <nil/crypto3/zk/math/expression_visitors.hpp>
+
+#include "parsers.hpp"
+#include "pipeline.hpp"
+
+template<typename BlueprintFieldType>
+struct circuit_container {
+    // We have to roll a custom container for this because ArithmetizationParams are constexpr in the circuit.
+    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
+    using plonk_gate_type = nil::crypto3::zk::snark::plonk_gate<BlueprintFieldType, plonk_constraint_type>;
+    using plonk_copy_constraint_type = nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType>;
+
+    circuit_container() : arena(std::make_shared<std::pmr::monotonic_buffer_resource>()) {}
+
+    circuit_sizes sizes;
+    std::vector<plonk_gate_type> gates;
+    std::vector<plonk_copy_constraint_type> copy_constraints;
+    // TODO: add lookup gates
+    // Data derived from the circuit, such as the expression DAG, is allocated here and released all at once
+    // when the last holder of the circuit goes away.
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> arena;
+};
+
+// Parses a circuit from a stream given by a read function, as taken by pipelined_table_reader::read.
+// Gates are sorted by their selectors. Throws std::runtime_error if the input is not a valid circuit,
+// errors thrown by read are passed through.
+template<typename BlueprintFieldType, typename ReadFunc>
+void read_circuit(ReadFunc read, circuit_container<BlueprintFieldType> &circuit_out) {
+    using plonk_constraint_type = typename circuit_container<BlueprintFieldType>::plonk_constraint_type;
+    using plonk_gate_type = typename circuit_container<BlueprintFieldType>::plonk_gate_type;
+    using plonk_copy_constraint_type = typename circuit_container<BlueprintFieldType>::plonk_copy_constraint_type;
+    using boost::spirit::qi::phrase_parse;
+
+    line_reader<ReadFunc> lines(std::move(read));
+    // The line buffer and the parsers are shared by all the lines of the file.
+    std::string line;
+    if (!lines.next(line)) {
+        throw std::runtime_error("Failed to read the header line");
+    }
+    circuit_sizes_parser<std::string::iterator> sizes_parser;
+    auto line_begin = line.begin();
+    bool r = phrase_parse(line_begin, line.end(), sizes_parser, boost::spirit::ascii::space, circuit_out.sizes);
+    if (!r || line_begin != line.end()) {
+        throw std::runtime_error("Failed to parse the header line");
+    }
+
+    circuit_out.gates.reserve(circuit_out.sizes.gates_size);
+    gate_header_parser<std::string::iterator> header_parser;
+    gate_constraint_parser<std::string::iterator, BlueprintFieldType> constraint_parser;
+    for (std::uint32_t i = 0; i < circuit_out.sizes.gates_size; i++) {
+        if (!lines.next(line)) {
+            throw std::runtime_error("Failed to read the header line of gate " + std::to_string(i + 1));
+        }
+        gate_header gate_header;
+        line_begin = line.begin();
+        r = phrase_parse(line_begin, line.end(), header_parser, boost::spirit::ascii::space, gate_header);
+        if (!r || line_begin != line.end()) {
+            throw std::runtime_error("Failed to parse the header line of gate " + std::to_string(i + 1));
+        }
+        std::vector<plonk_constraint_type> constraints;
+        constraints.reserve(gate_header.constraints_size);
+        for (std::size_t j = 0; j < gate_header.constraints_size; j++) {
+            plonk_constraint_type constraint;
+            if (!lines.next(line)) {
+                throw std::runtime_error("Failed to read constraint " + std::to_string(j + 1) + " of gate " +
+                                         std::to_string(i + 1));
+            }
+            line_begin = line.begin();
+            r = phrase_parse(line_begin, line.end(), constraint_parser, boost::spirit::ascii::space, constraint);
+            if (!r || line_begin != line.end()) {
+                throw std::runtime_error("Failed to parse constraint " + std::to_string(j + 1) + " of gate " +
+                                         std::to_string(i + 1));
+            }
+            constraints.push_back(std::move(constraint));
+        }
+
+        // plonk_gate copies the constraints it is constructed from, hand them over without a copy instead.
+        circuit_out.gates.emplace_back(gate_header.selector_index, std::vector<plonk_constraint_type>());
+        circuit_out.gates.back().constraints.swap(constraints);
+    }
+    std::sort(circuit_out.gates.begin(), circuit_out.gates.end(),
+              [](const plonk_gate_type& a, const plonk_gate_type& b) { return a.selector_index < b.selector_index; });
+
+    copy_constraint_parser<std::string::iterator, BlueprintFieldType> copy_constraint_parser;
+    circuit_out.copy_constraints.reserve(circuit_out.sizes.copy_constraints_size);
+    for (std::size_t i = 0; i < circuit_out.sizes.copy_constraints_size; i++) {
+        plonk_copy_constraint_type constraint;
+        if (!lines.next(line)) {
+            throw std::runtime_error("Failed to read copy constraint " + std::to_string(i + 1));
+        }
+        line_begin = line.begin();
+        r = phrase_parse(line_begin, line.end(), copy_constraint_parser, boost::spirit::ascii::space, constraint);
+        if (!r || line_begin != line.end()) {
+            throw std::runtime_error("Failed to parse copy constraint " + std::to_string(i + 1));
+        }
+        circuit_out.copy_constraints.push_back(constraint);
+    }
+}
+
+// Checks that the gates and copy constraints of a circuit only refer to selectors and columns of a table
+// of the given sizes, which evaluation and indexing take for granted. Throws std::runtime_error otherwise.
+template<typename BlueprintFieldType>
+void validate_circuit(const circuit_container<BlueprintFieldType> &circuit, const table_sizes &sizes) {
+    using var = nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>;
+
+    const std::size_t amounts[] = {sizes.witnesses_size, sizes.public_inputs_size, sizes.constants_size,
+                                   sizes.selectors_size};
+    auto in_table = [&amounts](const var &variable) {
+        return variable.type <= var::column_type::selector && variable.index < amounts[std::size_t(variable.type)];
+    };
+    for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+        const auto &gate = circuit.gates[i];
+        if (gate.selector_index >= sizes.selectors_size) {
+            throw std::runtime_error("Gate " + std::to_string(i) + " uses selector " +
+                                     std::to_string(gate.selector_index) + ", the table has " +
+                                     std::to_string(sizes.selectors_size));
+        }
+        bool fits = true;
+        std::function<void(var)> check_variable = [&fits, &in_table](var variable) {
+            fits = fits && in_table(variable);
+        };
+        nil::crypto3::math::expression_for_each_variable_visitor<var> visitor(check_variable);
+        for (std::size_t j = 0; j < gate.constraints.size(); j++) {
+            visitor.visit(gate.constraints[j]);
+            if (!fits) {
+                throw std::runtime_error("Constraint " + std::to_string(j) + " of gate " + std::to_string(i) +
+                                         " refers to a column which is not in the table");
+            }
+        }
+    }
+    for (std::size_t i = 0; i < circuit.copy_constraints.size(); i++) {
+        if (!in_table(circuit.copy_constraints[i].first) || !in_table(circuit.copy_constraints[i].second)) {
+            throw std::runtime_error("Copy constraint " + std::to_string(i) +
+                                     " refers to a column which is not in the table");
+        }
+    }
+}
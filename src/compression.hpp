@@ -0,0 +1,373 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#ifdef EXCALIBUR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+enum class compression_format {
+    none,
+    gzip,
+    zstd,
+};
+
+// Recognizes the format by the magic number at the start of the data.
+inline compression_format detect_compression(const unsigned char* data, std::size_t size) {
+    if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        return compression_format::gzip;
+    }
+    if (size >= 4 && data[0] == 0x28 && data[1] == 0xb5 && data[2] == 0x2f && data[3] == 0xfd) {
+        return compression_format::zstd;
+    }
+    return compression_format::none;
+}
+
+inline compression_format detect_file_compression(const std::string &path) {
+    unsigned char magic[4];
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return compression_format::none;
+    }
+    const std::size_t size = std::fread(magic, 1, sizeof(magic), file);
+    std::fclose(file);
+    return detect_compression(magic, size);
+}
+
+// Wraps a read function of the kind pipelined_table_reader takes, read(data, size) returning the amount of
+// bytes stored and 0 at the end of the input, and decompresses what it reads. The format is detected from
+// the first bytes, uncompressed input is passed through. gzip files may consist of several members.
+// zstd input made of several frames, as written by seekable or multithreaded compressors, is decompressed
+// a batch of frames at a time, one thread per frame. Frames which do not fit into the input window are
+// decompressed as a stream instead. Throws std::runtime_error on corrupted input.
+template<typename ReadFunc>
+class decompressing_reader {
+public:
+    decompressing_reader(ReadFunc read_, std::size_t threads_amount_ = 1)
+        : read(std::move(read_)), threads_amount(std::max<std::size_t>(1, threads_amount_)),
+          format(compression_format::none), started(false), input(input_window), input_begin(0), input_end(0),
+          input_finished(false), output_position(0), gzip_stream(), gzip_active(false), frame_open(false)
+#ifdef EXCALIBUR_HAVE_ZSTD
+          , zstd_stream(nullptr), zstd_streaming(false)
+#endif
+    {
+    }
+
+    ~decompressing_reader() {
+        if (gzip_active) {
+            inflateEnd(&gzip_stream);
+        }
+#ifdef EXCALIBUR_HAVE_ZSTD
+        ZSTD_freeDStream(zstd_stream);
+#endif
+    }
+
+    decompressing_reader(const decompressing_reader&) = delete;
+    decompressing_reader& operator=(const decompressing_reader&) = delete;
+
+    // Detects the format if nothing was read yet.
+    compression_format get_format() {
+        start();
+        return format;
+    }
+
+    std::size_t operator()(char* data, std::size_t size) {
+        start();
+        switch (format) {
+            case compression_format::none:
+                return read_plain(data, size);
+            case compression_format::gzip:
+                return read_gzip(data, size);
+            case compression_format::zstd:
+                return read_zstd(data, size);
+        }
+        return 0;
+    }
+
+private:
+    static constexpr std::size_t input_window = 1 << 22;
+    // Frames of a parallel batch have to fit into this much input.
+    static constexpr std::size_t max_input_window = 1 << 26;
+
+    void start() {
+        if (started) {
+            return;
+        }
+        started = true;
+        while (input_end < 4 && fill_input()) {
+        }
+        format = detect_compression(reinterpret_cast<const unsigned char*>(input.data()), input_end);
+        if (format == compression_format::gzip) {
+            // 16 makes zlib expect the gzip header and trailer.
+            if (inflateInit2(&gzip_stream, 16 + MAX_WBITS) != Z_OK) {
+                throw std::runtime_error("Failed to initialize the gzip decompressor");
+            }
+            gzip_active = true;
+        }
+#ifndef EXCALIBUR_HAVE_ZSTD
+        if (format == compression_format::zstd) {
+            throw std::runtime_error("The file is zstd-compressed, but zstd support is not compiled in");
+        }
+#endif
+    }
+
+    // Moves the unconsumed input to the front and reads more after it. Returns false at the end of the input.
+    bool fill_input() {
+        if (input_finished) {
+            return false;
+        }
+        if (input_begin != 0) {
+            std::memmove(input.data(), input.data() + input_begin, input_end - input_begin);
+            input_end -= input_begin;
+            input_begin = 0;
+        }
+        if (input_end == input.size()) {
+            input.resize(input.size() * 2);
+        }
+        const std::size_t read_size = read(input.data() + input_end, input.size() - input_end);
+        input_end += read_size;
+        input_finished = read_size == 0;
+        return !input_finished;
+    }
+
+    std::size_t read_plain(char* data, std::size_t size) {
+        if (input_begin != input_end) {
+            const std::size_t copied = std::min(size, input_end - input_begin);
+            std::memcpy(data, input.data() + input_begin, copied);
+            input_begin += copied;
+            return copied;
+        }
+        return input_finished ? 0 : read(data, size);
+    }
+
+    // Returns as soon as anything is decompressed.
+    std::size_t read_gzip(char* data, std::size_t size) {
+        const uInt wanted = uInt(std::min<std::size_t>(size, 1u << 30));
+        gzip_stream.next_out = reinterpret_cast<Bytef*>(data);
+        gzip_stream.avail_out = wanted;
+        while (gzip_stream.avail_out == wanted) {
+            if (input_begin == input_end && !fill_input() && input_begin == input_end) {
+                if (frame_open) {
+                    throw std::runtime_error("The gzip input is truncated");
+                }
+                break;
+            }
+            gzip_stream.next_in = reinterpret_cast<Bytef*>(input.data() + input_begin);
+            gzip_stream.avail_in = uInt(input_end - input_begin);
+            const int result = inflate(&gzip_stream, Z_NO_FLUSH);
+            input_begin = input_end - gzip_stream.avail_in;
+            if (result == Z_STREAM_END) {
+                // Another member may follow.
+                inflateReset(&gzip_stream);
+                frame_open = false;
+            } else if (result == Z_OK || result == Z_BUF_ERROR) {
+                frame_open = true;
+            } else {
+                throw std::runtime_error("Failed to decompress the gzip input");
+            }
+        }
+        return wanted - gzip_stream.avail_out;
+    }
+
+    std::size_t read_zstd(char* data, std::size_t size) {
+#ifdef EXCALIBUR_HAVE_ZSTD
+        while (output_position == (output.empty() ? 0 : output.front().size())) {
+            if (!output.empty()) {
+                output.pop_front();
+                output_position = 0;
+                continue;
+            }
+            if (zstd_streaming) {
+                return read_zstd_stream(data, size);
+            }
+            if (!decompress_frames()) {
+                if (input_begin == input_end) {
+                    return 0;
+                }
+                // The next frame is larger than the input window.
+                zstd_streaming = true;
+            }
+        }
+        const std::size_t copied = std::min(size, output.front().size() - output_position);
+        std::memcpy(data, output.front().data() + output_position, copied);
+        output_position += copied;
+        return copied;
+#else
+        (void)data;
+        (void)size;
+        return 0;
+#endif
+    }
+
+#ifdef EXCALIBUR_HAVE_ZSTD
+    // Finds the complete frames in the input window and decompresses them in parallel into output.
+    // Returns false if there was not a single complete frame.
+    bool decompress_frames() {
+        std::vector<std::pair<std::size_t, std::size_t>> frames;
+        while (frames.size() < 2 * threads_amount) {
+            const std::size_t offset = frames.empty() ? input_begin : frames.back().first + frames.back().second;
+            const std::size_t frame_size = offset == input_end ? 0 :
+                ZSTD_findFrameCompressedSize(input.data() + offset, input_end - offset);
+            if (offset != input_end && !ZSTD_isError(frame_size)) {
+                frames.emplace_back(offset, frame_size);
+                continue;
+            }
+            if (!frames.empty() || input_finished) {
+                if (frames.empty() && offset != input_end) {
+                    throw std::runtime_error("Failed to decompress the zstd input");
+                }
+                break;
+            }
+            // Offsets shift when the input is compacted, only done while no frame is found.
+            if (input.size() - (input_end - input_begin) == 0 && input.size() >= max_input_window) {
+                return false;
+            }
+            fill_input();
+        }
+        if (frames.empty()) {
+            return false;
+        }
+
+        std::vector<std::vector<char>> decompressed(frames.size());
+        std::vector<std::string> errors(frames.size());
+        auto decompress = [&](std::size_t t) {
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            for (std::size_t i = t; i < frames.size(); i += threads_amount) {
+                if (!decompress_frame(stream, input.data() + frames[i].first, frames[i].second, decompressed[i])) {
+                    errors[i] = "Failed to decompress the zstd input";
+                }
+            }
+            ZSTD_freeDStream(stream);
+        };
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < std::min(threads_amount, frames.size()); t++) {
+            threads.emplace_back(decompress, t);
+        }
+        decompress(0);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (std::size_t i = 0; i < frames.size(); i++) {
+            if (!errors[i].empty()) {
+                throw std::runtime_error(errors[i]);
+            }
+            // Skippable frames, like the seek table of the seekable format, produce nothing.
+            if (!decompressed[i].empty()) {
+                output.push_back(std::move(decompressed[i]));
+            }
+        }
+        input_begin = frames.back().first + frames.back().second;
+        return true;
+    }
+
+    static bool decompress_frame(ZSTD_DStream* stream, const char* data, std::size_t size, std::vector<char> &out) {
+        ZSTD_initDStream(stream);
+        const unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+        out.resize(content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR
+                       ? std::max<std::size_t>(size * 4, ZSTD_DStreamOutSize()) : std::size_t(content_size));
+        ZSTD_inBuffer in = {data, size, 0};
+        ZSTD_outBuffer out_buffer = {out.data(), out.size(), 0};
+        // zstd may still hold decompressed data after all of the input is consumed, so the frame is only done
+        // once ZSTD_decompressStream returns 0.
+        while (true) {
+            if (out_buffer.pos == out_buffer.size) {
+                out.resize(out.size() * 2 + ZSTD_DStreamOutSize());
+                out_buffer.dst = out.data();
+                out_buffer.size = out.size();
+            }
+            const std::size_t result = ZSTD_decompressStream(stream, &out_buffer, &in);
+            if (ZSTD_isError(result)) {
+                return false;
+            }
+            if (result == 0) {
+                break;
+            }
+            // Everything which could be flushed was, and more input is needed: the frame is truncated.
+            if (in.pos == in.size && out_buffer.pos != out_buffer.size) {
+                return false;
+            }
+        }
+        out.resize(out_buffer.pos);
+        return true;
+    }
+
+    std::size_t read_zstd_stream(char* data, std::size_t size) {
+        if (zstd_stream == nullptr) {
+            zstd_stream = ZSTD_createDStream();
+            ZSTD_initDStream(zstd_stream);
+        }
+        ZSTD_outBuffer out = {data, size, 0};
+        while (out.pos == 0) {
+            if (input_begin == input_end && !fill_input() && input_begin == input_end) {
+                if (frame_open) {
+                    throw std::runtime_error("The zstd input is truncated");
+                }
+                break;
+            }
+            ZSTD_inBuffer in = {input.data() + input_begin, input_end - input_begin, 0};
+            const std::size_t result = ZSTD_decompressStream(zstd_stream, &out, &in);
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error("Failed to decompress the zstd input");
+            }
+            // 0 means the frame is complete.
+            frame_open = result != 0;
+            input_begin += in.pos;
+        }
+        return out.pos;
+    }
+#endif
+
+    ReadFunc read;
+    const std::size_t threads_amount;
+    compression_format format;
+    bool started;
+    // Compressed input not consumed yet is input[input_begin, input_end).
+    std::vector<char> input;
+    std::size_t input_begin, input_end;
+    bool input_finished;
+    // Decompressed zstd frames waiting to be read, the first one is read from output_position.
+    std::deque<std::vector<char>> output;
+    std::size_t output_position;
+    z_stream gzip_stream;
+    bool gzip_active;
+    // A gzip member or a streamed zstd frame has been started and not finished.
+    bool frame_open;
+#ifdef EXCALIBUR_HAVE_ZSTD
+    ZSTD_DStream* zstd_stream;
+    bool zstd_streaming;
+#endif
+};
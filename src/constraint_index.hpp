@@ -0,0 +1,239 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/math/expression_visitors.hpp>
+
+#include "circuit.hpp"
+#include "store.hpp"
+
+// A sorted range of index entries.
+template<typename EntryType>
+struct entry_range {
+    const EntryType* first;
+    const EntryType* last;
+
+    const EntryType* begin() const {
+        return first;
+    }
+
+    const EntryType* end() const {
+        return last;
+    }
+
+    std::size_t size() const {
+        return last - first;
+    }
+};
+
+// Gate constraint instance, which touches the cell it is indexed under.
+struct gate_constraint_entry {
+    std::uint64_t cell;
+    std::uint32_t gate;
+    std::uint32_t constraint_num;
+    // Row at which the gate is applied, the cell itself can be at any rotation from it.
+    std::uint32_t row;
+};
+
+struct copy_constraint_entry {
+    std::uint64_t cell;
+    std::uint32_t constraint_num;
+};
+
+// For every cell of the table, stores the gate and copy constraints which involve that cell.
+// Entries are kept in flat arrays sorted by cell, so building and dropping the index are bulk operations
+// and lookups are binary searches. Rows touched by rotated variables are found by plain row arithmetic,
+// so any rotation is supported.
+template<typename BlueprintFieldType>
+class constraint_index {
+public:
+    using var = nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>;
+
+    constraint_index() : columns_amount(0) {}
+
+    void clear() {
+        gate_entries.clear();
+        gate_entries.shrink_to_fit();
+        copy_entries.clear();
+        copy_entries.shrink_to_fit();
+    }
+
+    // Of a partly loaded table only the constraints lying entirely in the loaded part are indexed,
+    // gate constraints applied close to the borders of the part are left out if any of their rotations cross them.
+    void build(const table_store<BlueprintFieldType> &store, const circuit_container<BlueprintFieldType> &circuit) {
+        clear();
+        columns_amount = store.get_columns_amount();
+        const std::int64_t rows_amount = store.get_rows_amount();
+        const table_window &window = store.get_window();
+        auto inside = [&](std::int64_t row, std::size_t column) {
+            return row >= 0 && row < rows_amount && window.is_column_loaded(column);
+        };
+
+        std::size_t outside_window = 0;
+        for (std::size_t i = 0; i < circuit.copy_constraints.size(); i++) {
+            const auto &constraint = circuit.copy_constraints[i];
+            const var variables[2] = {constraint.first, constraint.second};
+            std::int64_t rows[2];
+            std::size_t columns[2];
+            for (std::size_t end = 0; end < 2; end++) {
+                // Copy constraints use absolute variables, the rotation is the row.
+                rows[end] = store.get_store_row(variables[end].rotation);
+                columns[end] = store.get_column_index(variables[end]);
+            }
+            // A constraint with an end outside of the loaded part could not be shown, neither end is indexed.
+            if (!window.is_whole() && !(inside(rows[0], columns[0]) && inside(rows[1], columns[1]))) {
+                outside_window++;
+                continue;
+            }
+            for (std::size_t end = 0; end < 2; end++) {
+                if (!inside(rows[end], columns[end])) {
+                    std::cerr << "Copy constraint " << i << " refers to non-existent row "
+                              << variables[end].rotation << std::endl;
+                    continue;
+                }
+                copy_entries.push_back({get_cell(rows[end], columns[end]), std::uint32_t(i)});
+            }
+        }
+
+        std::size_t out_of_table = 0;
+        for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+            const auto &gate = circuit.gates[i];
+            const row_bitset &enabled_rows = store.get_selector_bitmap(gate.selector_index);
+            for (std::size_t j = 0; j < gate.constraints.size(); j++) {
+                std::vector<std::pair<std::size_t, std::int32_t>> cells = get_constraint_cells(store, gate, j);
+                enabled_rows.for_each_set([&](std::size_t k) {
+                    if (!window.is_whole() &&
+                            !std::all_of(cells.begin(), cells.end(), [&](const auto &cell) {
+                                return inside(std::int64_t(k) + cell.second, cell.first);
+                            })) {
+                        outside_window++;
+                        return;
+                    }
+                    for (const auto &[column, rotation] : cells) {
+                        std::int64_t cell_row = std::int64_t(k) + rotation;
+                        if (cell_row < 0 || cell_row >= rows_amount) {
+                            out_of_table++;
+                            continue;
+                        }
+                        gate_entries.push_back({get_cell(cell_row, column), std::uint32_t(i), std::uint32_t(j),
+                                                std::uint32_t(k)});
+                    }
+                });
+            }
+        }
+        if (out_of_table != 0) {
+            std::cerr << "Gate constraints refer to " << out_of_table << " cells outside of the table" << std::endl;
+        }
+        if (outside_window != 0) {
+            std::cout << outside_window << " constraints reach outside of the loaded part of the table "
+                      << "and are not indexed" << std::endl;
+        }
+
+        std::sort(gate_entries.begin(), gate_entries.end(),
+                  [](const gate_constraint_entry &a, const gate_constraint_entry &b) {
+                      return std::tie(a.cell, a.gate, a.constraint_num, a.row) <
+                             std::tie(b.cell, b.gate, b.constraint_num, b.row);
+                  });
+        std::stable_sort(copy_entries.begin(), copy_entries.end(),
+                         [](const copy_constraint_entry &a, const copy_constraint_entry &b) {
+                             return a.cell < b.cell;
+                         });
+    }
+
+    // Takes over entries built earlier for a table with columns_amount_ columns, e.g. saved in a session snapshot.
+    // They have to be sorted as build sorts them.
+    void assign(std::size_t columns_amount_, std::vector<gate_constraint_entry> gate_entries_,
+                std::vector<copy_constraint_entry> copy_entries_) {
+        columns_amount = columns_amount_;
+        gate_entries = std::move(gate_entries_);
+        copy_entries = std::move(copy_entries_);
+    }
+
+    const std::vector<gate_constraint_entry>& get_gate_entries() const {
+        return gate_entries;
+    }
+
+    const std::vector<copy_constraint_entry>& get_copy_entries() const {
+        return copy_entries;
+    }
+
+    entry_range<gate_constraint_entry> get_gate_constraints(std::size_t row, std::size_t column) const {
+        return find(gate_entries, get_cell(row, column));
+    }
+
+    entry_range<copy_constraint_entry> get_copy_constraints(std::size_t row, std::size_t column) const {
+        return find(copy_entries, get_cell(row, column));
+    }
+
+    std::size_t get_gate_entries_size() const {
+        return gate_entries.size();
+    }
+
+    std::size_t get_copy_entries_size() const {
+        return copy_entries.size();
+    }
+
+    // Store columns and rotations of the variables of a gate constraint, including the selector of the gate.
+    template<typename GateType>
+    static std::vector<std::pair<std::size_t, std::int32_t>> get_constraint_cells(
+            const table_store<BlueprintFieldType> &store, const GateType &gate, std::size_t constraint_num) {
+        std::set<var> variable_set;
+        std::function<void(var)> variable_extractor =
+            [&variable_set](var variable) { variable_set.insert(variable); };
+        nil::crypto3::math::expression_for_each_variable_visitor<var> visitor(variable_extractor);
+        visitor.visit(gate.constraints[constraint_num]);
+        variable_set.insert(var(gate.selector_index, 0, false, var::column_type::selector));
+
+        std::set<std::pair<std::size_t, std::int32_t>> cells;
+        for (const var &variable : variable_set) {
+            cells.insert(std::make_pair(store.get_column_index(variable), variable.rotation));
+        }
+        return std::vector<std::pair<std::size_t, std::int32_t>>(cells.begin(), cells.end());
+    }
+
+private:
+    std::uint64_t get_cell(std::size_t row, std::size_t column) const {
+        return std::uint64_t(row) * columns_amount + column;
+    }
+
+    template<typename EntryType>
+    static entry_range<EntryType> find(const std::vector<EntryType> &entries, std::uint64_t cell) {
+        auto range = std::equal_range(entries.begin(), entries.end(), EntryType{cell},
+                                      [](const EntryType &a, const EntryType &b) { return a.cell < b.cell; });
+        return entry_range<EntryType>{entries.data() + (range.first - entries.begin()),
+                                      entries.data() + (range.second - entries.begin())};
+    }
+
+    std::size_t columns_amount;
+    std::vector<gate_constraint_entry> gate_entries;
+    std::vector<copy_constraint_entry> copy_entries;
+};
@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// Public API of excalibur-core, the part of Excalibur which does not depend on GTK, for embedding into servers,
+// batch tools and tests. Link the excalibur-core CMake target and include this header.
+//
+// Everything is a template over the field, instantiated by the user:
+// - table_store holds the assignment table, pipelined_table_reader, text_page_source and shared_page_source
+//   fill it from text, paged text files and shared memory, watched_table_file keeps it in line with a file,
+//   table_window_reader reads a range of rows and some of the columns of a file into it;
+// - circuit_container holds a circuit, read_circuit parses one and validate_circuit checks it against a table;
+// - expression_dag and gate_evaluator compile the gates of a circuit and check tables against them,
+//   cached_check keeps the results between runs;
+// - constraint_index finds the constraints a cell takes part in, dependency_graph the cells connected by them;
+// - table_search and compare_tables search tables and compare two of them;
+// - save_session_snapshot and load_session_snapshot keep all of the above in a single file.
+//
+// Errors are reported by throwing std::runtime_error. The functions and classes listed here keep their signatures
+// within a major version, anything else in the headers may change.
+
+#define EXCALIBUR_CORE_VERSION_MAJOR 1
+#define EXCALIBUR_CORE_VERSION_MINOR 0
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "circuit.hpp"
+#include "compression.hpp"
+#include "constraint_index.hpp"
+#include "dependency_graph.hpp"
+#include "diff.hpp"
+#include "evaluator.hpp"
+#include "expression_dag.hpp"
+#include "field_traits.hpp"
+#include "paged_table.hpp"
+#include "parsers.hpp"
+#include "pipeline.hpp"
+#include "result_cache.hpp"
+#include "search.hpp"
+#include "shared_table.hpp"
+#include "snapshot.hpp"
+#include "store.hpp"
+#include "table_watch.hpp"
+#include "table_window.hpp"
+
+// Reads a local file, which may be compressed, through read_input(read), read being a read function
+// as taken by pipelined_table_reader::read.
+template<typename ReadInput>
+auto read_local_file(const std::string &path, std::size_t threads_amount, ReadInput read_input) {
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), std::fclose);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    auto read_file = [&file, &path](char* data, std::size_t size) {
+        const std::size_t read = std::fread(data, 1, size, file.get());
+        if (read == 0 && std::ferror(file.get())) {
+            throw std::runtime_error("Failed to read " + path);
+        }
+        return read;
+    };
+    decompressing_reader<decltype(read_file)> input(read_file, threads_amount);
+    return read_input([&input](char* data, std::size_t size) { return input(data, size); });
+}
+
+// Reads a table file, which may be compressed. threads_amount of 0 uses all the cores.
+template<typename BlueprintFieldType>
+std::shared_ptr<table_store<BlueprintFieldType>> load_table_file(const std::string &path,
+                                                                 std::size_t threads_amount = 0) {
+    if (threads_amount == 0) {
+        // One core reads, the rest parse.
+        threads_amount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+    pipelined_table_reader<BlueprintFieldType> reader(threads_amount);
+    return read_local_file(path, threads_amount, [&reader](auto read) { return reader.read(read); });
+}
+
+// Reads a circuit file, which may be compressed.
+template<typename BlueprintFieldType>
+void load_circuit_file(const std::string &path, circuit_container<BlueprintFieldType> &circuit_out) {
+    read_local_file(path, 1, [&circuit_out](auto read) {
+        read_circuit(read, circuit_out);
+        return 0;
+    });
+}
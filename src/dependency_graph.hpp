@@ -0,0 +1,391 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "circuit.hpp"
+#include "constraint_index.hpp"
+#include "evaluator.hpp"
+#include "store.hpp"
+
+// Graph of the dependencies between cells and the constraints on them: a cell is linked to the gates
+// applied at rows which touch it and to its copy constraints, a gate is linked to all of its cells.
+// The graph is grown lazily from a single cell a few hops at a time, up to a node budget, so it stays
+// small on circuits of any size.
+// The layout is incremental: new nodes are put next to the node they were reached from and only they and
+// their neighbourhood are moved afterwards, the rest of the picture stays where the user has seen it.
+template<typename BlueprintFieldType>
+class dependency_graph {
+public:
+    using var = nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>;
+
+    enum class node_kind : std::uint8_t {
+        cell,
+        gate,
+        copy_constraint,
+    };
+
+    enum class node_state : std::uint8_t {
+        unknown,
+        satisfied,
+        unsatisfied,
+    };
+
+    struct node {
+        node_kind kind;
+        node_state state;
+        // Whether all the neighbours of the node are in the graph.
+        bool expanded;
+        // Cell row, row at which the gate is applied, or the copy constraint number.
+        std::uint32_t row;
+        // Store column of the cell, or gate number.
+        std::uint32_t column;
+        float x, y;
+        // How far the node may still move, new nodes start hot and cool down as the layout settles.
+        float heat;
+        std::uint64_t grid_key;
+    };
+
+    struct edge {
+        std::uint32_t from;
+        std::uint32_t to;
+    };
+
+    static constexpr float edge_length = 60;
+
+    dependency_graph() : node_budget(1000) {}
+
+    void clear() {
+        nodes.clear();
+        edges.clear();
+        adjacency.clear();
+        node_of.clear();
+        grid.clear();
+    }
+
+    void set_node_budget(std::size_t budget) {
+        node_budget = budget;
+    }
+
+    std::size_t get_node_budget() const {
+        return node_budget;
+    }
+
+    const std::vector<node>& get_nodes() const {
+        return nodes;
+    }
+
+    const std::vector<edge>& get_edges() const {
+        return edges;
+    }
+
+    bool empty() const {
+        return nodes.empty();
+    }
+
+    // Starts a new graph from the cell.
+    void reset(std::size_t row, std::size_t column) {
+        clear();
+        add_node(node_kind::cell, row, column, 0, 0);
+    }
+
+    // Adds everything within hops hops of the node, stops once the node budget is reached.
+    // Returns the amount of added nodes.
+    std::size_t expand(const table_store<BlueprintFieldType> &store,
+                       const circuit_container<BlueprintFieldType> &circuit,
+                       const constraint_index<BlueprintFieldType> &index,
+                       const gate_evaluator<BlueprintFieldType> &evaluator,
+                       std::size_t start, std::size_t hops) {
+        const std::size_t old_size = nodes.size();
+        std::vector<std::size_t> depth(nodes.size(), hops + 1);
+        std::deque<std::uint32_t> queue;
+        depth[start] = 0;
+        queue.push_back(std::uint32_t(start));
+        while (!queue.empty() && nodes.size() < node_budget) {
+            std::uint32_t current = queue.front();
+            queue.pop_front();
+            if (depth[current] >= hops) {
+                continue;
+            }
+            if (!nodes[current].expanded) {
+                expand_node(store, circuit, index, evaluator, current);
+                depth.resize(nodes.size(), hops + 1);
+            }
+            for (std::uint32_t neighbour : adjacency[current]) {
+                if (depth[neighbour] > depth[current] + 1) {
+                    depth[neighbour] = depth[current] + 1;
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+        // Let the neighbourhood of the new nodes make room for them.
+        for (std::size_t i = old_size; i < nodes.size(); i++) {
+            for (std::uint32_t neighbour : adjacency[i]) {
+                nodes[neighbour].heat = std::max(nodes[neighbour].heat, 0.3f);
+            }
+        }
+        return nodes.size() - old_size;
+    }
+
+    // One step of force-directed layout over the hot nodes. Repulsion is only computed between nodes
+    // in neighbouring grid cells, so a step costs about the amount of hot nodes.
+    // Returns false once the layout has settled.
+    bool layout_step() {
+        bool moving = false;
+        for (std::size_t i = 0; i < nodes.size(); i++) {
+            node &current = nodes[i];
+            if (current.heat < min_heat) {
+                continue;
+            }
+            moving = true;
+            float force_x = 0, force_y = 0;
+            for_each_near(current.x, current.y, [&](std::uint32_t other) {
+                if (other == i) {
+                    return;
+                }
+                float dx = current.x - nodes[other].x, dy = current.y - nodes[other].y;
+                float distance_squared = std::max(dx * dx + dy * dy, 1.0f);
+                if (distance_squared > grid_size * grid_size) {
+                    return;
+                }
+                float repulsion = edge_length * edge_length / distance_squared;
+                force_x += dx * repulsion;
+                force_y += dy * repulsion;
+            });
+            for (std::uint32_t other : adjacency[i]) {
+                float dx = nodes[other].x - current.x, dy = nodes[other].y - current.y;
+                float distance = std::max(std::sqrt(dx * dx + dy * dy), 1.0f);
+                float attraction = (distance - edge_length) / edge_length;
+                force_x += dx / distance * attraction * edge_length;
+                force_y += dy / distance * attraction * edge_length;
+            }
+            float force = std::sqrt(force_x * force_x + force_y * force_y);
+            float max_step = current.heat * edge_length * 0.5f;
+            if (force > max_step) {
+                force_x *= max_step / force;
+                force_y *= max_step / force;
+            }
+            move_node(std::uint32_t(i), current.x + force_x, current.y + force_y);
+            current.heat *= cooling;
+        }
+        return moving;
+    }
+
+    // Node closest to the point within radius of it, or nodes.size() if there is none.
+    std::size_t find_node_at(float x, float y, float radius) const {
+        std::size_t result = nodes.size();
+        float best = radius * radius;
+        for_each_near(x, y, [&](std::uint32_t other) {
+            float dx = nodes[other].x - x, dy = nodes[other].y - y;
+            if (dx * dx + dy * dy <= best) {
+                best = dx * dx + dy * dy;
+                result = other;
+            }
+        });
+        return result;
+    }
+
+private:
+    static constexpr float grid_size = edge_length * 2;
+    static constexpr float min_heat = 0.01f;
+    static constexpr float cooling = 0.92f;
+
+    static std::uint64_t get_key(node_kind kind, std::uint64_t row, std::uint64_t column) {
+        return (std::uint64_t(kind) << 62) | (row << 24) | column;
+    }
+
+    static std::uint64_t get_grid_key(float x, float y) {
+        std::int32_t grid_x = std::int32_t(std::floor(x / grid_size));
+        std::int32_t grid_y = std::int32_t(std::floor(y / grid_size));
+        return (std::uint64_t(std::uint32_t(grid_x)) << 32) | std::uint32_t(grid_y);
+    }
+
+    template<typename Function>
+    void for_each_near(float x, float y, Function f) const {
+        for (int i = -1; i <= 1; i++) {
+            for (int j = -1; j <= 1; j++) {
+                auto it = grid.find(get_grid_key(x + i * grid_size, y + j * grid_size));
+                if (it == grid.end()) {
+                    continue;
+                }
+                for (std::uint32_t other : it->second) {
+                    f(other);
+                }
+            }
+        }
+    }
+
+    void move_node(std::uint32_t idx, float x, float y) {
+        node &current = nodes[idx];
+        current.x = x;
+        current.y = y;
+        std::uint64_t grid_key = get_grid_key(x, y);
+        if (grid_key == current.grid_key) {
+            return;
+        }
+        std::vector<std::uint32_t> &old_cell = grid[current.grid_key];
+        *std::find(old_cell.begin(), old_cell.end(), idx) = old_cell.back();
+        old_cell.pop_back();
+        if (old_cell.empty()) {
+            grid.erase(current.grid_key);
+        }
+        grid[grid_key].push_back(idx);
+        current.grid_key = grid_key;
+    }
+
+    // Returns the node, adding it if it is not in the graph yet and the budget allows.
+    std::uint32_t add_node(node_kind kind, std::size_t row, std::size_t column, float x, float y) {
+        std::uint64_t key = get_key(kind, row, column);
+        auto it = node_of.find(key);
+        if (it != node_of.end()) {
+            return it->second;
+        }
+        if (nodes.size() >= node_budget) {
+            return std::uint32_t(nodes.size());
+        }
+        std::uint32_t idx = std::uint32_t(nodes.size());
+        std::uint64_t grid_key = get_grid_key(x, y);
+        nodes.push_back({kind, node_state::unknown, false, std::uint32_t(row), std::uint32_t(column), x, y, 1.0f,
+                         grid_key});
+        adjacency.emplace_back();
+        node_of.emplace(key, idx);
+        grid[grid_key].push_back(idx);
+        return idx;
+    }
+
+    // Returns false if the neighbour did not fit into the budget.
+    bool link(std::uint32_t from, node_kind kind, std::size_t row, std::size_t column) {
+        // New nodes are spread around the node they are reached from.
+        const float golden_angle = 2.39996323f;
+        float angle = float(adjacency[from].size()) * golden_angle;
+        float x = nodes[from].x + edge_length * std::cos(angle);
+        float y = nodes[from].y + edge_length * std::sin(angle);
+        std::uint32_t to = add_node(kind, row, column, x, y);
+        if (to == nodes.size()) {
+            return false;
+        }
+        if (std::find(adjacency[from].begin(), adjacency[from].end(), to) == adjacency[from].end()) {
+            adjacency[from].push_back(to);
+            adjacency[to].push_back(from);
+            edges.push_back({from, to});
+        }
+        return true;
+    }
+
+    void expand_node(const table_store<BlueprintFieldType> &store,
+                     const circuit_container<BlueprintFieldType> &circuit,
+                     const constraint_index<BlueprintFieldType> &index,
+                     const gate_evaluator<BlueprintFieldType> &evaluator,
+                     std::uint32_t idx) {
+        // Copy, the vector may be reallocated while the node is expanded.
+        const node current = nodes[idx];
+        bool complete = true;
+        switch (current.kind) {
+            case node_kind::cell: {
+                for (const auto &entry : index.get_copy_constraints(current.row, current.column)) {
+                    complete = link(idx, node_kind::copy_constraint, entry.constraint_num, 0) && complete;
+                }
+                for (const auto &entry : index.get_gate_constraints(current.row, current.column)) {
+                    std::uint64_t key = get_key(node_kind::gate, entry.row, entry.gate);
+                    bool is_new = node_of.count(key) == 0;
+                    complete = link(idx, node_kind::gate, entry.row, entry.gate) && complete;
+                    if (is_new) {
+                        update_gate_state(store, evaluator, key);
+                    }
+                }
+                break;
+            }
+            case node_kind::gate: {
+                const std::size_t selector_column =
+                    store.get_selector_column_index(circuit.gates[current.column].selector_index);
+                complete = link(idx, node_kind::cell, current.row, selector_column);
+                for (const var &variable : evaluator.get_registers(current.column)) {
+                    std::int64_t row = std::int64_t(current.row) + variable.rotation;
+                    if (row < 0 || row >= std::int64_t(store.get_rows_amount())) {
+                        continue;
+                    }
+                    complete = link(idx, node_kind::cell, row, store.get_column_index(variable)) && complete;
+                }
+                break;
+            }
+            case node_kind::copy_constraint: {
+                const auto &constraint = circuit.copy_constraints[current.row];
+                std::size_t columns[2];
+                std::int64_t rows[2];
+                bool inside = true;
+                for (std::size_t i = 0; i < 2; i++) {
+                    const var &variable = i == 0 ? constraint.first : constraint.second;
+                    columns[i] = store.get_column_index(variable);
+                    rows[i] = store.get_store_row(variable.rotation);
+                    if (rows[i] < 0 || rows[i] >= std::int64_t(store.get_rows_amount()) ||
+                            !store.get_window().is_column_loaded(columns[i])) {
+                        inside = false;
+                        continue;
+                    }
+                    complete = link(idx, node_kind::cell, rows[i], columns[i]) && complete;
+                }
+                if (inside) {
+                    nodes[idx].state = store.get_cell(columns[0], rows[0]) == store.get_cell(columns[1], rows[1])
+                                           ? node_state::satisfied
+                                           : node_state::unsatisfied;
+                }
+                break;
+            }
+        }
+        nodes[idx].expanded = complete;
+    }
+
+    void update_gate_state(const table_store<BlueprintFieldType> &store,
+                           const gate_evaluator<BlueprintFieldType> &evaluator, std::uint64_t key) {
+        auto it = node_of.find(key);
+        if (it == node_of.end()) {
+            return;
+        }
+        node &gate_node = nodes[it->second];
+        if (!evaluator.fits(store, gate_node.column, gate_node.row)) {
+            return;
+        }
+        evaluator.evaluate(store, gate_node.column, gate_node.row, evaluation_context);
+        bool satisfied = std::all_of(evaluation_context.results.begin(), evaluation_context.results.end(),
+                                     [](const auto &result) {
+                                         return field_traits<BlueprintFieldType>::is_zero(result);
+                                     });
+        gate_node.state = satisfied ? node_state::satisfied : node_state::unsatisfied;
+    }
+
+    std::size_t node_budget;
+    std::vector<node> nodes;
+    std::vector<edge> edges;
+    std::vector<std::vector<std::uint32_t>> adjacency;
+    std::unordered_map<std::uint64_t, std::uint32_t> node_of;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> grid;
+    typename gate_evaluator<BlueprintFieldType>::context evaluation_context;
+};
@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "parsers.hpp"
+#include "search.hpp"
+#include "store.hpp"
+
+inline bool same_table_sizes(const table_sizes &a, const table_sizes &b) {
+    return a.witnesses_size == b.witnesses_size && a.public_inputs_size == b.public_inputs_size &&
+           a.constants_size == b.constants_size && a.selectors_size == b.selectors_size &&
+           a.max_size == b.max_size;
+}
+
+struct table_diff_result {
+    // Sorted by row, then column.
+    std::vector<cell_position> cells;
+    std::size_t row_blocks_amount = 0;
+    // Row blocks without differences.
+    std::size_t identical_row_blocks = 0;
+    bool truncated = false;
+};
+
+// Compares two tables of the same sizes. Row blocks are distributed over the available cores and compared
+// cell by cell, except for column blocks which are left unallocated in both tables, as those only hold zeroes.
+// At most max_cells differences are returned.
+template<typename BlueprintFieldType>
+table_diff_result compare_tables(const table_store<BlueprintFieldType> &a, const table_store<BlueprintFieldType> &b,
+                                 std::size_t max_cells) {
+    using store_type = table_store<BlueprintFieldType>;
+
+    table_diff_result result;
+    result.row_blocks_amount = a.get_row_blocks_amount();
+    // Paged stores can only be read from one thread.
+    const std::size_t max_threads = a.is_paged() || b.is_paged() ? 1 : std::thread::hardware_concurrency();
+    const std::size_t threads_amount =
+        std::max<std::size_t>(1, std::min<std::size_t>(max_threads, result.row_blocks_amount));
+    std::vector<std::vector<cell_position>> thread_cells(threads_amount);
+    std::vector<std::size_t> thread_identical(threads_amount, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        threads.emplace_back([&, t]() {
+            for (std::size_t block = t; block < result.row_blocks_amount && thread_cells[t].size() <= max_cells;
+                 block += threads_amount) {
+                const std::size_t first_row = block * store_type::block_rows;
+                const std::size_t cells_before = thread_cells[t].size();
+                for (std::size_t column = 0; column < a.get_columns_amount(); column++) {
+                    // Neither block can be held on to, reading the other one may page the first one out.
+                    if (a.get_column_block(column, block).empty() && b.get_column_block(column, block).empty()) {
+                        continue;
+                    }
+                    const std::size_t last_row = std::min(a.get_rows_amount(), first_row + store_type::block_rows);
+                    for (std::size_t row = first_row; row < last_row; row++) {
+                        if (!(a.get_cell(column, row) == b.get_cell(column, row))) {
+                            thread_cells[t].push_back({std::uint32_t(row), std::uint32_t(column)});
+                        }
+                    }
+                }
+                if (thread_cells[t].size() == cells_before) {
+                    thread_identical[t]++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        result.cells.insert(result.cells.end(), thread_cells[t].begin(), thread_cells[t].end());
+        result.identical_row_blocks += thread_identical[t];
+    }
+    std::sort(result.cells.begin(), result.cells.end());
+    if (result.cells.size() > max_cells) {
+        result.cells.resize(max_cells);
+        result.truncated = true;
+    }
+    return result;
+}
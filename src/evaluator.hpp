@@ -0,0 +1,310 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/math/expression.hpp>
+#include <nil/crypto3/zk/math/expression_visitors.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/constraint.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/variable.hpp>
+
+#include "circuit.hpp"
+#include "expression_dag.hpp"
+#include "field_traits.hpp"
+#include "store.hpp"
+
+// Evaluates a gate constraint at the given row. Variables of the constraint are put into variable_set.
+template<typename BlueprintFieldType>
+typename BlueprintFieldType::value_type evaluate_constraint(
+        const table_store<BlueprintFieldType> &store,
+        const nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType> &constraint, std::size_t row_idx,
+        std::set<nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>> &variable_set) {
+    using var = nil::crypto3::zk::snark::plonk_variable<typename BlueprintFieldType::value_type>;
+
+    std::function<void(var)> variable_extractor =
+        [&variable_set](var variable) { variable_set.insert(variable); };
+    nil::crypto3::math::expression_for_each_variable_visitor<var> visitor(variable_extractor);
+    visitor.visit(constraint);
+
+    std::map<std::tuple<std::size_t, int, typename var::column_type>, typename var::assignment_type>
+        evaluation_map;
+    for (const var &variable : variable_set) {
+        std::int64_t var_row = std::int64_t(row_idx) + variable.rotation;
+        if (var_row < 0 || var_row >= std::int64_t(store.get_rows_amount())) {
+            throw std::out_of_range("Constraint at row " + std::to_string(row_idx) +
+                                    " refers to a cell outside of the table");
+        }
+        evaluation_map[std::make_tuple(variable.index, variable.rotation, variable.type)] =
+            store.get(store.get_column_index(variable), var_row);
+    }
+    return constraint.evaluate(evaluation_map);
+}
+
+// Evaluates all the constraints of a gate at once.
+// Every gate is compiled from the expression DAG into a flat program over a small array of slots:
+// the union of the gate variables is fetched into the first slots once per row, then constants,
+// then the operations of all the constraints, with subexpressions shared between constraints computed once.
+// Slots hold store cells directly, so for small fields the whole program runs on machine words.
+template<typename BlueprintFieldType>
+class gate_evaluator {
+public:
+    using value_type = typename BlueprintFieldType::value_type;
+    using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
+    using node_kind = typename expression_dag<BlueprintFieldType>::node_kind;
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+
+    struct context {
+        std::vector<cell_type> slots;
+        std::vector<cell_type> results;
+    };
+
+    struct failure {
+        std::uint32_t gate;
+        std::uint32_t constraint_num;
+        std::uint32_t row;
+    };
+
+    struct check_result {
+        std::vector<failure> failures;
+        std::size_t evaluations = 0;
+        // Enabled rows at which the gate does not fit into the table, or into the loaded part of it.
+        std::size_t out_of_table_rows = 0;
+    };
+
+    void clear() {
+        programs.clear();
+    }
+
+    void build(const expression_dag<BlueprintFieldType> &dag, const circuit_container<BlueprintFieldType> &circuit) {
+        const auto &nodes = dag.get_nodes();
+        programs.clear();
+        programs.resize(circuit.gates.size());
+        for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+            gate_program &program = programs[i];
+            program.selector_index = circuit.gates[i].selector_index;
+            const std::size_t constraints_amount = circuit.gates[i].constraints.size();
+
+            std::vector<std::uint32_t> gate_nodes;
+            for (std::size_t j = 0; j < constraints_amount; j++) {
+                const auto &constraint_nodes = dag.get_constraint_nodes(i, j);
+                gate_nodes.insert(gate_nodes.end(), constraint_nodes.begin(), constraint_nodes.end());
+            }
+            std::sort(gate_nodes.begin(), gate_nodes.end());
+            gate_nodes.erase(std::unique(gate_nodes.begin(), gate_nodes.end()), gate_nodes.end());
+
+            // Variables go first, then constants, then operations in evaluation order.
+            std::map<std::uint32_t, std::uint32_t> slot_of;
+            for (std::uint32_t node_idx : gate_nodes) {
+                if (nodes[node_idx].kind == node_kind::variable) {
+                    slot_of[node_idx] = std::uint32_t(program.registers.size());
+                    const var &variable = dag.get_variables()[nodes[node_idx].left];
+                    program.registers.push_back(variable);
+                    program.min_rotation = std::min(program.min_rotation, std::int64_t(variable.rotation));
+                    program.max_rotation = std::max(program.max_rotation, std::int64_t(variable.rotation));
+                }
+            }
+            for (std::uint32_t node_idx : gate_nodes) {
+                if (nodes[node_idx].kind == node_kind::constant) {
+                    slot_of[node_idx] = std::uint32_t(program.registers.size() + program.constants.size());
+                    program.constants.push_back(traits::from_value(dag.get_constants()[nodes[node_idx].left]));
+                }
+            }
+            std::uint32_t next_slot = std::uint32_t(program.registers.size() + program.constants.size());
+            for (std::uint32_t node_idx : gate_nodes) {
+                const auto &current = nodes[node_idx];
+                if (current.kind == node_kind::variable || current.kind == node_kind::constant) {
+                    continue;
+                }
+                slot_of[node_idx] = next_slot;
+                program.instructions.push_back({current.kind, slot_of[current.left],
+                                                current.kind == node_kind::pow ? current.right
+                                                                               : slot_of[current.right],
+                                                next_slot});
+                next_slot++;
+            }
+            program.slots_size = next_slot;
+            for (std::size_t j = 0; j < constraints_amount; j++) {
+                program.outputs.push_back(slot_of[dag.get_root(i, j)]);
+            }
+        }
+    }
+
+    std::size_t get_gates_amount() const {
+        return programs.size();
+    }
+
+    std::size_t get_registers_size(std::size_t gate) const {
+        return programs[gate].registers.size();
+    }
+
+    // Union of the variables of all the constraints of the gate.
+    const std::vector<var>& get_registers(std::size_t gate) const {
+        return programs[gate].registers;
+    }
+
+    // Whether all the cells the gate reads at the row are in the store. Cells of a partly loaded table
+    // are also outside of it if their columns are not loaded.
+    bool fits(const table_store<BlueprintFieldType> &store, std::size_t gate, std::size_t row) const {
+        const gate_program &program = programs[gate];
+        return fits_rows(store, program, row) && reads_loaded_columns(store, program);
+    }
+
+    // Values of all the constraints of the gate are put into ctx.results, in the order of the gate.
+    // Throws std::out_of_range if the gate refers to a cell outside of the table.
+    void evaluate(const table_store<BlueprintFieldType> &store, std::size_t gate, std::size_t row,
+                  context &ctx) const {
+        if (!fits(store, gate, row)) {
+            throw std::out_of_range("Gate " + std::to_string(gate) + " at row " + std::to_string(row) +
+                                    " refers to a cell outside of the table");
+        }
+        evaluate_unchecked(store, programs[gate], row, ctx);
+    }
+
+    // Smallest and largest rotation over all the gates, the rotation of the selector is zero.
+    std::pair<std::int64_t, std::int64_t> get_rotation_range() const {
+        std::pair<std::int64_t, std::int64_t> result(0, 0);
+        for (const gate_program &program : programs) {
+            result.first = std::min(result.first, program.min_rotation);
+            result.second = std::max(result.second, program.max_rotation);
+        }
+        return result;
+    }
+
+    // Evaluates every gate at every row where its selector is enabled and collects the failed constraints.
+    // Failures are ordered by gate, then row.
+    check_result check(const table_store<BlueprintFieldType> &store) const {
+        return check_rows(store, 0, store.get_rows_amount());
+    }
+
+    // Same as check, for the gates applied at rows [first_row, last_row) only.
+    check_result check_rows(const table_store<BlueprintFieldType> &store, std::size_t first_row,
+                            std::size_t last_row) const {
+        check_result result;
+        context ctx;
+        for (std::size_t i = 0; i < programs.size(); i++) {
+            const gate_program &program = programs[i];
+            const row_bitset &enabled_rows = store.get_selector_bitmap(program.selector_index);
+            const bool columns_loaded = reads_loaded_columns(store, program);
+            enabled_rows.for_each_set(first_row, last_row, [&](std::size_t row) {
+                if (!columns_loaded || !fits_rows(store, program, row)) {
+                    result.out_of_table_rows++;
+                    return;
+                }
+                evaluate_unchecked(store, program, row, ctx);
+                result.evaluations += ctx.results.size();
+                for (std::size_t j = 0; j < ctx.results.size(); j++) {
+                    if (!traits::is_zero(ctx.results[j])) {
+                        result.failures.push_back({std::uint32_t(i), std::uint32_t(j), std::uint32_t(row)});
+                    }
+                }
+            });
+        }
+        return result;
+    }
+
+private:
+    struct instruction {
+        node_kind kind;
+        // For pow right is the power.
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t output;
+    };
+
+    struct gate_program {
+        std::size_t selector_index = 0;
+        std::vector<var> registers;
+        std::vector<cell_type> constants;
+        std::vector<instruction> instructions;
+        std::vector<std::uint32_t> outputs;
+        std::size_t slots_size = 0;
+        std::int64_t min_rotation = 0;
+        std::int64_t max_rotation = 0;
+    };
+
+    static bool fits_rows(const table_store<BlueprintFieldType> &store, const gate_program &program,
+                          std::size_t row) {
+        return std::int64_t(row) + program.min_rotation >= 0 &&
+               std::int64_t(row) + program.max_rotation < std::int64_t(store.get_rows_amount());
+    }
+
+    static bool reads_loaded_columns(const table_store<BlueprintFieldType> &store, const gate_program &program) {
+        const table_window &window = store.get_window();
+        if (window.columns.empty()) {
+            return true;
+        }
+        return std::all_of(program.registers.begin(), program.registers.end(), [&](const var &variable) {
+            return window.is_column_loaded(store.get_column_index(variable));
+        });
+    }
+
+    void evaluate_unchecked(const table_store<BlueprintFieldType> &store, const gate_program &program,
+                            std::size_t row, context &ctx) const {
+        auto &slots = ctx.slots;
+        if (slots.size() < program.slots_size) {
+            slots.resize(program.slots_size);
+        }
+        std::size_t slot = 0;
+        for (const var &variable : program.registers) {
+            slots[slot++] = store.get_cell(store.get_column_index(variable), row + variable.rotation);
+        }
+        for (const cell_type &constant : program.constants) {
+            slots[slot++] = constant;
+        }
+        for (const instruction &op : program.instructions) {
+            switch (op.kind) {
+                case node_kind::add:
+                    slots[op.output] = traits::add(slots[op.left], slots[op.right]);
+                    break;
+                case node_kind::sub:
+                    slots[op.output] = traits::sub(slots[op.left], slots[op.right]);
+                    break;
+                case node_kind::mul:
+                    slots[op.output] = traits::mul(slots[op.left], slots[op.right]);
+                    break;
+                case node_kind::pow:
+                    slots[op.output] = traits::pow(slots[op.left], op.right);
+                    break;
+                default:
+                    break;
+            }
+        }
+        ctx.results.resize(program.outputs.size());
+        for (std::size_t j = 0; j < program.outputs.size(); j++) {
+            ctx.results[j] = slots[program.outputs[j]];
+        }
+    }
+
+    std::vector<gate_program> programs;
+};
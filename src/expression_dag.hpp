@@ -0,0 +1,391 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/variant.hpp>
+
+#include <nil/crypto3/zk/math/expression.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/constraint.hpp>
+#include <nil/crypto3/zk/snark/arithmetization/plonk/variable.hpp>
+
+#include "circuit.hpp"
+#include "store.hpp"
+
+// Hash-consed representation of all the gate constraints of a circuit.
+// Structurally equal subexpressions are stored once, no matter in which gate or constraint they appear,
+// and are evaluated once per row through row_context.
+// Nodes are created after their operands, so ascending node order is a valid evaluation order.
+template<typename BlueprintFieldType>
+class expression_dag {
+public:
+    using value_type = typename BlueprintFieldType::value_type;
+    using integral_type = typename BlueprintFieldType::integral_type;
+    using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
+    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
+
+    enum class node_kind : std::uint8_t { constant, variable, add, sub, mul, pow };
+
+    // For constants and variables left is an index into constants or variables, for pow right is the power.
+    struct node {
+        node_kind kind;
+        std::uint32_t left;
+        std::uint32_t right;
+    };
+
+    // Scratch space for evaluating a single row, nodes computed for one constraint are reused by the others.
+    struct row_context {
+        std::vector<value_type> values;
+        std::vector<std::uint32_t> stamps;
+        std::uint32_t stamp = 0;
+        std::size_t row = 0;
+    };
+
+    expression_dag() : data(std::make_unique<storage>(std::pmr::get_default_resource())) {}
+
+    // The storage is dropped before the arena it was allocated from.
+    void clear() {
+        data = std::make_unique<storage>(std::pmr::get_default_resource());
+        arena.reset();
+        tree_nodes_size = 0;
+        tree_memory_size = 0;
+    }
+
+    // All the nodes are allocated from the arena of the circuit.
+    void build(const circuit_container<BlueprintFieldType> &circuit) {
+        clear();
+        arena = circuit.arena;
+        data = std::make_unique<storage>(arena.get());
+        data->roots.resize(circuit.gates.size());
+        data->constraint_nodes.resize(circuit.gates.size());
+        data->constraint_variables.resize(circuit.gates.size());
+        for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+            const auto &constraints = circuit.gates[i].constraints;
+            for (std::size_t j = 0; j < constraints.size(); j++) {
+                std::uint32_t root = intern(constraints[j]);
+                data->roots[i].push_back(root);
+                data->constraint_nodes[i].push_back(collect_nodes(root));
+                std::pmr::vector<var> constraint_vars(arena.get());
+                for (std::uint32_t node_idx : data->constraint_nodes[i].back()) {
+                    if (data->nodes[node_idx].kind == node_kind::variable) {
+                        constraint_vars.push_back(data->variables[data->nodes[node_idx].left]);
+                    }
+                }
+                data->constraint_variables[i].push_back(std::move(constraint_vars));
+            }
+        }
+    }
+
+    // Takes over a DAG built earlier for the same circuit, e.g. saved in a session snapshot, instead of interning
+    // its constraints again. Nodes have to be in evaluation order. Roots and node lists of the constraints are
+    // flattened over the gates and their constraints, the nodes of the k-th constraint are
+    // constraint_nodes_[node_offsets[k]] up to constraint_nodes_[node_offsets[k + 1]].
+    // Nothing is known about the trees the DAG was built from after this, and intern must not be called.
+    void assign(const circuit_container<BlueprintFieldType> &circuit, const node* nodes_, std::size_t nodes_size,
+                const std::vector<value_type> &constants_, const std::vector<var> &variables_,
+                const std::uint32_t* roots_, const std::uint64_t* node_offsets,
+                const std::uint32_t* constraint_nodes_) {
+        clear();
+        arena = circuit.arena;
+        data = std::make_unique<storage>(arena.get());
+        data->nodes.assign(nodes_, nodes_ + nodes_size);
+        data->constants.assign(constants_.begin(), constants_.end());
+        data->variables.assign(variables_.begin(), variables_.end());
+        data->roots.resize(circuit.gates.size());
+        data->constraint_nodes.resize(circuit.gates.size());
+        data->constraint_variables.resize(circuit.gates.size());
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+            for (std::size_t j = 0; j < circuit.gates[i].constraints.size(); j++, k++) {
+                data->roots[i].push_back(roots_[k]);
+                data->constraint_nodes[i].emplace_back(constraint_nodes_ + node_offsets[k],
+                                                       constraint_nodes_ + node_offsets[k + 1]);
+                std::pmr::vector<var> constraint_vars(arena.get());
+                for (std::uint32_t node_idx : data->constraint_nodes[i].back()) {
+                    if (data->nodes[node_idx].kind == node_kind::variable) {
+                        constraint_vars.push_back(data->variables[data->nodes[node_idx].left]);
+                    }
+                }
+                data->constraint_variables[i].push_back(std::move(constraint_vars));
+            }
+        }
+    }
+
+    std::uint32_t intern(const nil::crypto3::math::expression<var> &expr) {
+        interner visitor(*this);
+        return boost::apply_visitor(visitor, expr.get_expr());
+    }
+
+    std::uint32_t get_root(std::size_t gate, std::size_t constraint_num) const {
+        return data->roots[gate][constraint_num];
+    }
+
+    // Distinct variables of the constraint.
+    const std::pmr::vector<var>& get_constraint_variables(std::size_t gate, std::size_t constraint_num) const {
+        return data->constraint_variables[gate][constraint_num];
+    }
+
+    const std::pmr::vector<node>& get_nodes() const {
+        return data->nodes;
+    }
+
+    const std::pmr::vector<value_type>& get_constants() const {
+        return data->constants;
+    }
+
+    const std::pmr::vector<var>& get_variables() const {
+        return data->variables;
+    }
+
+    // Nodes reachable from the root of the constraint, in evaluation order.
+    const std::pmr::vector<std::uint32_t>& get_constraint_nodes(std::size_t gate, std::size_t constraint_num) const {
+        return data->constraint_nodes[gate][constraint_num];
+    }
+
+    std::size_t get_nodes_size() const {
+        return data->nodes.size();
+    }
+
+    // Amount of nodes the constraints would take as separate trees.
+    std::size_t get_tree_nodes_size() const {
+        return tree_nodes_size;
+    }
+
+    std::size_t get_memory_size() const {
+        return data->nodes.size() * sizeof(node) + data->constants.size() * sizeof(value_type) +
+               data->variables.size() * sizeof(var);
+    }
+
+    std::size_t get_tree_memory_size() const {
+        return tree_memory_size;
+    }
+
+    void begin_row(row_context &context, std::size_t row) const {
+        if (context.values.size() != data->nodes.size()) {
+            context.values.assign(data->nodes.size(), value_type::zero());
+            context.stamps.assign(data->nodes.size(), 0);
+            context.stamp = 0;
+        }
+        if (++context.stamp == 0) {
+            std::fill(context.stamps.begin(), context.stamps.end(), 0);
+            context.stamp = 1;
+        }
+        context.row = row;
+    }
+
+    // Throws std::out_of_range if the constraint refers to a cell outside of the table.
+    const value_type& evaluate(const table_store<BlueprintFieldType> &store, row_context &context,
+                               std::size_t gate, std::size_t constraint_num) const {
+        for (std::uint32_t node_idx : data->constraint_nodes[gate][constraint_num]) {
+            if (context.stamps[node_idx] == context.stamp) {
+                continue;
+            }
+            context.values[node_idx] = evaluate_node(store, context, data->nodes[node_idx]);
+            context.stamps[node_idx] = context.stamp;
+        }
+        return context.values[data->roots[gate][constraint_num]];
+    }
+
+    value_type evaluate(const table_store<BlueprintFieldType> &store, std::size_t gate, std::size_t constraint_num,
+                        std::size_t row) const {
+        row_context context;
+        begin_row(context, row);
+        return evaluate(store, context, gate, constraint_num);
+    }
+
+private:
+    struct interner : boost::static_visitor<std::uint32_t> {
+        expression_dag &dag;
+
+        interner(expression_dag &dag_) : dag(dag_) {}
+
+        std::uint32_t operator()(const nil::crypto3::math::term<var> &term) const {
+            // Variables of a product commute, sort them so that equal terms written differently match.
+            std::vector<var> term_vars = term.get_vars();
+            std::sort(term_vars.begin(), term_vars.end());
+            const bool unit_coeff = term.get_coeff() == value_type::one();
+            if (term_vars.empty() || !unit_coeff) {
+                std::uint32_t result = dag.make_constant(term.get_coeff());
+                for (const var &variable : term_vars) {
+                    result = dag.make_operation(node_kind::mul, result, dag.make_variable(variable));
+                }
+                return result;
+            }
+            std::uint32_t result = dag.make_variable(term_vars[0]);
+            for (std::size_t i = 1; i < term_vars.size(); i++) {
+                result = dag.make_operation(node_kind::mul, result, dag.make_variable(term_vars[i]));
+            }
+            return result;
+        }
+
+        std::uint32_t operator()(const nil::crypto3::math::pow_operation<var> &pow) const {
+            std::uint32_t base = boost::apply_visitor(*this, pow.get_expr().get_expr());
+            return dag.make_operation(node_kind::pow, base, std::uint32_t(pow.get_power()));
+        }
+
+        std::uint32_t operator()(const nil::crypto3::math::binary_arithmetic_operation<var> &op) const {
+            std::uint32_t left = boost::apply_visitor(*this, op.get_expr_left().get_expr());
+            std::uint32_t right = boost::apply_visitor(*this, op.get_expr_right().get_expr());
+            switch (op.get_op()) {
+                case nil::crypto3::math::ArithmeticOperator::ADD:
+                    return dag.make_operation(node_kind::add, std::min(left, right), std::max(left, right));
+                case nil::crypto3::math::ArithmeticOperator::SUB:
+                    return dag.make_operation(node_kind::sub, left, right);
+                case nil::crypto3::math::ArithmeticOperator::MULT:
+                    return dag.make_operation(node_kind::mul, std::min(left, right), std::max(left, right));
+                default:
+                    throw std::runtime_error("Unsupported arithmetic operator in constraint");
+            }
+        }
+    };
+
+    std::uint32_t push_node(node_kind kind, std::uint32_t left, std::uint32_t right) {
+        data->nodes.push_back({kind, left, right});
+        return std::uint32_t(data->nodes.size() - 1);
+    }
+
+    std::uint32_t make_constant(const value_type &value) {
+        tree_nodes_size++;
+        tree_memory_size += sizeof(node) + sizeof(value_type);
+        integral_type key = integral_type(value.data);
+        auto it = data->constant_nodes.find(key);
+        if (it != data->constant_nodes.end()) {
+            return it->second;
+        }
+        data->constants.push_back(value);
+        std::uint32_t node_idx = push_node(node_kind::constant, std::uint32_t(data->constants.size() - 1), 0);
+        data->constant_nodes.emplace(key, node_idx);
+        return node_idx;
+    }
+
+    std::uint32_t make_variable(const var &variable) {
+        tree_nodes_size++;
+        tree_memory_size += sizeof(node) + sizeof(var);
+        auto it = data->variable_nodes.find(variable);
+        if (it != data->variable_nodes.end()) {
+            return it->second;
+        }
+        data->variables.push_back(variable);
+        std::uint32_t node_idx = push_node(node_kind::variable, std::uint32_t(data->variables.size() - 1), 0);
+        data->variable_nodes.emplace(variable, node_idx);
+        return node_idx;
+    }
+
+    std::uint32_t make_operation(node_kind kind, std::uint32_t left, std::uint32_t right) {
+        tree_nodes_size++;
+        tree_memory_size += sizeof(node);
+        auto key = std::make_tuple(kind, left, right);
+        auto it = data->operation_nodes.find(key);
+        if (it != data->operation_nodes.end()) {
+            return it->second;
+        }
+        std::uint32_t node_idx = push_node(kind, left, right);
+        data->operation_nodes.emplace(key, node_idx);
+        return node_idx;
+    }
+
+    std::pmr::vector<std::uint32_t> collect_nodes(std::uint32_t root) const {
+        std::pmr::vector<std::uint32_t> result(data->nodes.get_allocator());
+        std::vector<std::uint32_t> stack = {root};
+        std::vector<bool> visited(data->nodes.size(), false);
+        while (!stack.empty()) {
+            std::uint32_t node_idx = stack.back();
+            stack.pop_back();
+            if (visited[node_idx]) {
+                continue;
+            }
+            visited[node_idx] = true;
+            result.push_back(node_idx);
+            const node &current = data->nodes[node_idx];
+            if (current.kind == node_kind::constant || current.kind == node_kind::variable) {
+                continue;
+            }
+            stack.push_back(current.left);
+            if (current.kind != node_kind::pow) {
+                stack.push_back(current.right);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    value_type evaluate_node(const table_store<BlueprintFieldType> &store, const row_context &context,
+                             const node &current) const {
+        switch (current.kind) {
+            case node_kind::constant:
+                return data->constants[current.left];
+            case node_kind::variable: {
+                const var &variable = data->variables[current.left];
+                std::int64_t var_row = std::int64_t(context.row) + variable.rotation;
+                if (var_row < 0 || var_row >= std::int64_t(store.get_rows_amount())) {
+                    throw std::out_of_range("Constraint at row " + std::to_string(context.row) +
+                                            " refers to a cell outside of the table");
+                }
+                return store.get(store.get_column_index(variable), var_row);
+            }
+            case node_kind::add:
+                return context.values[current.left] + context.values[current.right];
+            case node_kind::sub:
+                return context.values[current.left] - context.values[current.right];
+            case node_kind::mul:
+                return context.values[current.left] * context.values[current.right];
+            case node_kind::pow:
+                return context.values[current.left].pow(current.right);
+        }
+        return value_type::zero();
+    }
+
+    // Everything the DAG owns, in the arena of the circuit it was built for.
+    struct storage {
+        explicit storage(std::pmr::memory_resource *resource) :
+                nodes(resource), constants(resource), variables(resource), constant_nodes(resource),
+                variable_nodes(resource), operation_nodes(resource), roots(resource), constraint_nodes(resource),
+                constraint_variables(resource) {}
+
+        std::pmr::vector<node> nodes;
+        std::pmr::vector<value_type> constants;
+        std::pmr::vector<var> variables;
+        std::pmr::map<integral_type, std::uint32_t> constant_nodes;
+        std::pmr::map<var, std::uint32_t> variable_nodes;
+        std::pmr::map<std::tuple<node_kind, std::uint32_t, std::uint32_t>, std::uint32_t> operation_nodes;
+        // Per gate, per constraint.
+        std::pmr::vector<std::pmr::vector<std::uint32_t>> roots;
+        std::pmr::vector<std::pmr::vector<std::pmr::vector<std::uint32_t>>> constraint_nodes;
+        std::pmr::vector<std::pmr::vector<std::pmr::vector<var>>> constraint_variables;
+    };
+
+    // Declared first so that it outlives the storage.
+    std::shared_ptr<std::pmr::memory_resource> arena;
+    std::unique_ptr<storage> data;
+    std::size_t tree_nodes_size = 0;
+    std::size_t tree_memory_size = 0;
+};
@@ -0,0 +1,197 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// How table cells of a field are parsed, stored and computed with.
+// The generic version goes through the multiprecision value_type of the field.
+template<typename BlueprintFieldType, typename Enable = void>
+struct field_traits {
+    using value_type = typename BlueprintFieldType::value_type;
+    using integral_type = typename BlueprintFieldType::integral_type;
+    // What the table row parser produces for a cell.
+    using parsed_type = integral_type;
+    // What the table store keeps for a cell.
+    using cell_type = value_type;
+
+    static constexpr bool is_small = false;
+    static constexpr std::size_t limbs_amount = (BlueprintFieldType::modulus_bits + 63) / 64;
+
+    static cell_type from_parsed(const parsed_type &value) {
+        return value_type(value);
+    }
+
+    static cell_type from_value(const value_type &value) {
+        return value;
+    }
+
+    static value_type to_value(const cell_type &cell) {
+        return cell;
+    }
+
+    static parsed_type to_parsed(const cell_type &cell) {
+        return integral_type(cell.data);
+    }
+
+    static bool is_zero(const cell_type &cell) {
+        return cell == 0;
+    }
+
+    // Not stable across builds, only meant for in-memory hash tables.
+    static std::uint64_t hash(const cell_type &cell) {
+        const integral_type limb_mask = integral_type(~std::uint64_t(0));
+        integral_type rest = integral_type(cell.data);
+        std::uint64_t result = 0;
+        while (rest != 0) {
+            result = (result ^ static_cast<std::uint64_t>(rest & limb_mask)) * 0x9e3779b97f4a7c15;
+            rest >>= 64;
+        }
+        return result;
+    }
+
+    // Something std::ostream formats as the hex digits of the cell.
+    static const auto& printable(const cell_type &cell) {
+        return cell.data;
+    }
+
+    // Cells are written to files as little-endian 64-bit limbs, unlike hash this is stable across builds.
+    static void to_limbs(const cell_type &cell, std::uint64_t* limbs) {
+        const integral_type limb_mask = integral_type(~std::uint64_t(0));
+        integral_type rest = integral_type(cell.data);
+        for (std::size_t i = 0; i < limbs_amount; i++) {
+            limbs[i] = static_cast<std::uint64_t>(rest & limb_mask);
+            rest >>= 64;
+        }
+    }
+
+    static cell_type from_limbs(const std::uint64_t* limbs) {
+        integral_type value = 0;
+        for (std::size_t i = limbs_amount; i-- > 0;) {
+            value <<= 64;
+            value |= integral_type(limbs[i]);
+        }
+        return value_type(value);
+    }
+
+    static cell_type add(const cell_type &a, const cell_type &b) {
+        return a + b;
+    }
+
+    static cell_type sub(const cell_type &a, const cell_type &b) {
+        return a - b;
+    }
+
+    static cell_type mul(const cell_type &a, const cell_type &b) {
+        return a * b;
+    }
+
+    static cell_type pow(const cell_type &a, std::uint32_t power) {
+        return a.pow(power);
+    }
+};
+
+// Fields whose elements fit into a machine word, such as Goldilocks, keep cells as raw std::uint64_t
+// reduced modulo the field modulus, and use native arithmetic for them.
+template<typename BlueprintFieldType>
+struct field_traits<BlueprintFieldType, std::enable_if_t<(BlueprintFieldType::modulus_bits <= 64)>> {
+    using value_type = typename BlueprintFieldType::value_type;
+    using integral_type = typename BlueprintFieldType::integral_type;
+    using parsed_type = std::uint64_t;
+    using cell_type = std::uint64_t;
+
+    static constexpr bool is_small = true;
+    static constexpr std::size_t limbs_amount = 1;
+
+    static std::uint64_t modulus() {
+        static const std::uint64_t value = static_cast<std::uint64_t>(integral_type(BlueprintFieldType::modulus));
+        return value;
+    }
+
+    static cell_type from_parsed(parsed_type value) {
+        return value < modulus() ? value : value % modulus();
+    }
+
+    static cell_type from_value(const value_type &value) {
+        return static_cast<std::uint64_t>(integral_type(value.data));
+    }
+
+    static value_type to_value(cell_type cell) {
+        return value_type(integral_type(cell));
+    }
+
+    static parsed_type to_parsed(cell_type cell) {
+        return cell;
+    }
+
+    static bool is_zero(cell_type cell) {
+        return cell == 0;
+    }
+
+    static std::uint64_t hash(cell_type cell) {
+        return cell * 0x9e3779b97f4a7c15;
+    }
+
+    static const cell_type& printable(const cell_type &cell) {
+        return cell;
+    }
+
+    static void to_limbs(cell_type cell, std::uint64_t* limbs) {
+        limbs[0] = cell;
+    }
+
+    static cell_type from_limbs(const std::uint64_t* limbs) {
+        return from_parsed(limbs[0]);
+    }
+
+    static cell_type add(cell_type a, cell_type b) {
+        // a + b < 2 * modulus, on overflow the wrapped subtraction still gives the right result.
+        cell_type result = a + b;
+        if (result < a || result >= modulus()) {
+            result -= modulus();
+        }
+        return result;
+    }
+
+    static cell_type sub(cell_type a, cell_type b) {
+        return a >= b ? a - b : a + (modulus() - b);
+    }
+
+    static cell_type mul(cell_type a, cell_type b) {
+        return static_cast<cell_type>((unsigned __int128)(a) * b % modulus());
+    }
+
+    static cell_type pow(cell_type a, std::uint32_t power) {
+        cell_type result = 1 % modulus();
+        while (power != 0) {
+            if (power & 1) {
+                result = mul(result, a);
+            }
+            a = mul(a, a);
+            power >>= 1;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <glibmm/init.h>
+#include <glibmm/optioncontext.h>
+#include <glibmm/optiongroup.h>
+
+#include <nil/crypto3/algebra/fields/vesta/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/vesta.hpp>
+#include <nil/crypto3/algebra/curves/vesta.hpp>
+#include <nil/crypto3/algebra/fields/pallas/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/pallas.hpp>
+#include <nil/crypto3/algebra/curves/pallas.hpp>
+
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt6/base_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/goldilocks64.hpp>
+#include <nil/crypto3/algebra/curves/alt_bn128.hpp>
+
+#include "nil/crypto3/algebra/fields/alt_bn128/scalar_field.hpp"
+#include "generator.hpp"
+#include "shared_table.hpp"
+
+// Stands in for a prover process handing its table over through shared memory.
+template<typename BlueprintFieldType>
+void write_shared_table(const synthetic_generator<BlueprintFieldType> &generator, const std::string &name) {
+    using traits = field_traits<BlueprintFieldType>;
+    const table_sizes &sizes = generator.get_params().sizes;
+    const std::size_t columns_amount = sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size +
+                                       sizes.selectors_size;
+    shared_table_writer<BlueprintFieldType> writer(name, sizes);
+    for (std::size_t row = 0; row < sizes.max_size; row++) {
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            writer.set(column, row, traits::from_value(generator.table_value(row, column)));
+        }
+    }
+    writer.publish();
+}
+
+template<typename BlueprintFieldType>
+int generate(const generator_params &params, const std::string &table_path, const std::string &circuit_path,
+             const std::string &shared_table) {
+    try {
+        synthetic_generator<BlueprintFieldType> generator(params);
+        {
+            buffered_writer circuit_writer(circuit_path);
+            generator.write_circuit(circuit_writer);
+        }
+        if (!shared_table.empty()) {
+            write_shared_table(generator, shared_table);
+            return 0;
+        }
+        buffered_writer table_writer(table_path);
+        generator.write_table(table_writer);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Glib::init();
+
+    using vesta_curve_type = nil::crypto3::algebra::curves::vesta::base_field_type;
+    using pallas_curve_type = nil::crypto3::algebra::curves::pallas::base_field_type;
+    using bls12_fr_381_curve_type = nil::crypto3::algebra::fields::bls12_fr<381>;
+    using bls12_fq_381_curve_type = nil::crypto3::algebra::fields::bls12_fq<381>;
+    using mnt4_curve_type = nil::crypto3::algebra::fields::mnt4_fq<298>;
+    using mnt6_curve_type = nil::crypto3::algebra::fields::mnt6_fq<298>;
+    using goldilocks64_field_type = nil::crypto3::algebra::fields::goldilocks64;
+    using bn_base_field_type = nil::crypto3::algebra::fields::alt_bn128<254>;
+    using bn_scalar_field_type = nil::crypto3::algebra::fields::alt_bn128_scalar_field<254>;
+
+    Glib::OptionGroup main_group("curves", "Curves", "Curve used in the program");
+
+    bool vesta = false, pallas = false, bls12_fr_381 = false, bls12_fq_381 = false,
+         mnt4 = false, mnt6 = false, goldilocks64 = false, bn_base = false, bn_scalar = false;
+    std::vector<std::tuple<const char*, char, const char*, bool*>> curve_entries = {
+        {"vesta", 'v', "Use Vesta curve", &vesta},
+        {"pallas", 'p', "Use Pallas curve", &pallas},
+        {"bls12_fr_381", 'b', "Use BLS12_fr_381 curve", &bls12_fr_381},
+        {"bls12_fq_381", 'q', "Use BLS12_fq_381 curve", &bls12_fq_381},
+        {"mnt4", '4', "Use mnt4 curve", &mnt4},
+        {"mnt6", '6', "Use mnt6 curve", &mnt6},
+        {"goldilocks64", 'g', "Use Goldilocks64 curve", &goldilocks64},
+        {"bn", 'n', "Use BN curve base field", &bn_base},
+        {"bn_scalar", 's', "Use BN curve scalar field", &bn_scalar}};
+    for (auto &[long_name, short_name, description, flag] : curve_entries) {
+        Glib::OptionEntry entry;
+        entry.set_long_name(long_name);
+        entry.set_short_name(short_name);
+        entry.set_description(description);
+        main_group.add_entry(entry, *flag);
+    }
+
+    Glib::OptionGroup sizes_group("sizes", "Sizes", "Sizes of the generated table and circuit");
+    int rows = 1 << 16, witnesses = 15, public_inputs = 1, constants = 1, gates = 8,
+        constraints_per_gate = 4, terms_per_constraint = 3, degree = 2, max_rotation = 1, copy_constraints = 0,
+        seed = 0;
+    double unsatisfied_fraction = 0;
+    Glib::ustring table_path = "table.txt", circuit_path = "circuit.txt", shared_table;
+    std::vector<std::tuple<const char*, const char*, int*>> size_entries = {
+        {"rows", "Amount of rows in the table", &rows},
+        {"witnesses", "Amount of witness columns", &witnesses},
+        {"public_inputs", "Amount of public input columns", &public_inputs},
+        {"constants", "Amount of constant columns", &constants},
+        {"gates", "Amount of gates, each gate gets its own selector column", &gates},
+        {"constraints", "Amount of constraints per gate", &constraints_per_gate},
+        {"terms", "Amount of terms per constraint", &terms_per_constraint},
+        {"degree", "Amount of variables in each term", &degree},
+        {"max_rotation", "Maximum absolute rotation of a gate variable", &max_rotation},
+        {"copy_constraints", "Amount of copy constraints", &copy_constraints},
+        {"seed", "Random seed", &seed}};
+    for (auto &[long_name, description, value] : size_entries) {
+        Glib::OptionEntry entry;
+        entry.set_long_name(long_name);
+        entry.set_description(description);
+        sizes_group.add_entry(entry, *value);
+    }
+    Glib::OptionEntry unsatisfied_entry, table_entry, circuit_entry;
+    unsatisfied_entry.set_long_name("unsatisfied");
+    unsatisfied_entry.set_description("Fraction of constraints which are generated unsatisfied");
+    sizes_group.add_entry(unsatisfied_entry, unsatisfied_fraction);
+    table_entry.set_long_name("table");
+    table_entry.set_description("Output table file");
+    sizes_group.add_entry(table_entry, table_path);
+    circuit_entry.set_long_name("circuit");
+    circuit_entry.set_description("Output circuit file");
+    sizes_group.add_entry(circuit_entry, circuit_path);
+    Glib::OptionEntry shared_table_entry;
+    shared_table_entry.set_long_name("shared_table");
+    shared_table_entry.set_description(
+        "Write the table into this POSIX shared memory segment instead of the table file, e.g. /excalibur");
+    sizes_group.add_entry(shared_table_entry, shared_table);
+
+    Glib::OptionContext context;
+    context.set_main_group(main_group);
+    context.add_group(sizes_group);
+    context.set_help_enabled(true);
+    context.parse(argc, argv);
+
+    std::vector<bool> curve_selections = {
+        vesta, pallas, bls12_fr_381, bls12_fq_381, mnt4, mnt6, goldilocks64, bn_base, bn_scalar};
+    uint8_t curve_count = std::accumulate(curve_selections.begin(), curve_selections.end(), 0);
+    if (curve_count != 1) {
+        std::cerr << "Error: exactly one curve has to be selected." << std::endl;
+        return 1;
+    }
+    if (rows <= 0 || witnesses <= 0 || public_inputs < 0 || constants < 0 || gates < 0 ||
+        constraints_per_gate <= 0 || terms_per_constraint <= 0 || degree <= 0 || max_rotation < 0 ||
+        copy_constraints < 0) {
+        std::cerr << "Error: sizes have to be positive." << std::endl;
+        return 1;
+    }
+
+    generator_params params;
+    params.sizes.witnesses_size = witnesses;
+    params.sizes.public_inputs_size = public_inputs;
+    params.sizes.constants_size = constants;
+    params.sizes.selectors_size = gates;
+    params.sizes.max_size = rows;
+    params.constraints_per_gate = constraints_per_gate;
+    params.terms_per_constraint = terms_per_constraint;
+    params.degree = degree;
+    params.max_rotation = max_rotation;
+    params.copy_constraints_size = copy_constraints;
+    params.unsatisfied_fraction = unsatisfied_fraction;
+    params.seed = seed;
+
+    if (vesta) {
+        return generate<vesta_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (pallas) {
+        return generate<pallas_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (bls12_fr_381) {
+        return generate<bls12_fr_381_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (bls12_fq_381) {
+        return generate<bls12_fq_381_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (mnt4) {
+        return generate<mnt4_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (mnt6) {
+        return generate<mnt6_curve_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (goldilocks64) {
+        return generate<goldilocks64_field_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (bn_base) {
+        return generate<bn_base_field_type>(params, table_path, circuit_path, shared_table);
+    }
+    if (bn_scalar) {
+        return generate<bn_scalar_field_type>(params, table_path, circuit_path, shared_table);
+    }
+}
@@ -0,0 +1,414 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parsers.hpp"
+
+// Generates tables and circuits in the format accepted by the parsers in parsers.hpp.
+// Nothing is kept in memory except for the circuit description: cell values are derived from a counter-based
+// random function of (row, column), so any cell can be recomputed when a neighbouring row or a copy constraint
+// needs it. This allows writing tables of 2^24 rows with hundreds of columns.
+//
+// Witness columns are split into inputs and outputs. Every gate constraint has the form
+//     w_out - sum(coeff * product of input variables) = 0
+// where the inputs may be rotated. The generator computes the outputs, so the table satisfies the circuit,
+// except for the constraints which were deliberately broken with unsatisfied_fraction.
+
+struct generator_params {
+    // selectors_size is also the amount of gates, every gate has its own selector.
+    table_sizes sizes;
+    std::size_t constraints_per_gate = 4;
+    std::size_t terms_per_constraint = 3;
+    std::size_t degree = 2;
+    std::int32_t max_rotation = 1;
+    std::size_t copy_constraints_size = 0;
+    // Fraction of gate constraint instances and copy constraints which are generated unsatisfied.
+    double unsatisfied_fraction = 0;
+    std::uint64_t seed = 0;
+};
+
+// Writes into a file through a large buffer, avoids going through iostreams for every value.
+class buffered_writer {
+public:
+    buffered_writer(const std::string &path, std::size_t buffer_size = 1 << 22) : buffer(), used(0) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open " + path + " for writing");
+        }
+        buffer.resize(buffer_size);
+    }
+
+    ~buffered_writer() {
+        flush();
+        std::fclose(file);
+    }
+
+    buffered_writer(const buffered_writer&) = delete;
+    buffered_writer& operator=(const buffered_writer&) = delete;
+
+    void write(const char* data, std::size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) {
+                std::fwrite(data, 1, size, file);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    void write(const std::string &data) {
+        write(data.data(), data.size());
+    }
+
+    void flush() {
+        if (used != 0) {
+            std::fwrite(buffer.data(), 1, used, file);
+            used = 0;
+        }
+    }
+
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::size_t used;
+};
+
+// Appends the hex representation of value without leading zeroes.
+template<typename IntegralType>
+void append_hex(std::string &out, IntegralType value) {
+    static const char digits[] = "0123456789abcdef";
+    if (value == 0) {
+        out.push_back('0');
+        return;
+    }
+    const IntegralType chunk_mask = IntegralType(0xFFFFFFFFFFFFFFFFull);
+    char reversed[1024];
+    std::size_t length = 0;
+    while (value != 0) {
+        std::uint64_t chunk = static_cast<std::uint64_t>(value & chunk_mask);
+        value >>= 64;
+        for (std::size_t i = 0; i < 16 && (chunk != 0 || value != 0); i++) {
+            reversed[length++] = digits[chunk & 0xF];
+            chunk >>= 4;
+        }
+    }
+    while (length != 0) {
+        out.push_back(reversed[--length]);
+    }
+}
+
+inline std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template<typename BlueprintFieldType>
+class synthetic_generator {
+public:
+    using value_type = typename BlueprintFieldType::value_type;
+    using integral_type = typename BlueprintFieldType::integral_type;
+
+    struct synthetic_variable {
+        std::size_t column;
+        std::int32_t rotation;
+    };
+
+    struct synthetic_term {
+        std::uint64_t coeff;
+        bool negative;
+        std::vector<synthetic_variable> variables;
+    };
+
+    struct synthetic_constraint {
+        std::size_t output;
+        std::vector<synthetic_term> terms;
+    };
+
+    struct synthetic_copy_constraint {
+        // Copies public input 0 of source_row into an input witness cell.
+        std::size_t source_row;
+        std::size_t target_row, target_column;
+        bool unsatisfied;
+    };
+
+    synthetic_generator(const generator_params &params_) : params(params_) {
+        const table_sizes &sizes = params.sizes;
+        if (sizes.witnesses_size <= params.constraints_per_gate) {
+            throw std::invalid_argument("Generator needs more witness columns than constraints per gate");
+        }
+        if (sizes.max_size <= 2 * std::size_t(params.max_rotation)) {
+            throw std::invalid_argument("Generator needs more rows than rotations span");
+        }
+        if (params.copy_constraints_size != 0 && sizes.public_inputs_size == 0) {
+            throw std::invalid_argument("Generator needs a public input column for copy constraints");
+        }
+        inputs_size = sizes.witnesses_size - params.constraints_per_gate;
+        std::uint64_t state = params.seed;
+        auto next = [&state]() { return splitmix64(state++); };
+        unsatisfied_threshold = params.unsatisfied_fraction >= 1 ?
+            std::uint64_t(-1) : std::uint64_t(params.unsatisfied_fraction * 18446744073709551616.0);
+
+        gates.resize(sizes.selectors_size);
+        for (auto &gate : gates) {
+            gate.resize(params.constraints_per_gate);
+            for (std::size_t j = 0; j < params.constraints_per_gate; j++) {
+                gate[j].output = inputs_size + j;
+                gate[j].terms.resize(params.terms_per_constraint);
+                for (auto &term : gate[j].terms) {
+                    term.coeff = next() % 1000 + 1;
+                    term.negative = next() & 1;
+                    for (std::size_t k = 0; k < params.degree; k++) {
+                        std::int32_t rotation = std::int32_t(next() % (2 * params.max_rotation + 1)) -
+                                                params.max_rotation;
+                        term.variables.push_back({std::size_t(next() % inputs_size), rotation});
+                    }
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < params.copy_constraints_size; i++) {
+            synthetic_copy_constraint constraint;
+            constraint.source_row = next() % sizes.max_size;
+            constraint.target_row = next() % sizes.max_size;
+            constraint.target_column = next() % inputs_size;
+            constraint.unsatisfied = next() < unsatisfied_threshold;
+            auto key = std::make_pair(constraint.target_row, constraint.target_column);
+            if (copy_targets.count(key) != 0) {
+                continue;
+            }
+            copy_targets[key] = copy_constraints.size();
+            copy_constraints.push_back(constraint);
+        }
+    }
+
+    const generator_params& get_params() const {
+        return params;
+    }
+
+    // Might be less than requested in params, as copy constraints with coinciding targets are dropped.
+    std::size_t get_copy_constraints_size() const {
+        return copy_constraints.size();
+    }
+
+    // Returns the index of the gate enabled at row, or gates amount if no gate is enabled there.
+    std::size_t enabled_gate(std::size_t row) const {
+        if (gates.empty() || row < std::size_t(params.max_rotation) ||
+            row + params.max_rotation >= params.sizes.max_size) {
+            return gates.size();
+        }
+        return row % gates.size();
+    }
+
+    void append_table_header(std::string &line) const {
+        const table_sizes &sizes = params.sizes;
+        line += "witnesses_size: " + std::to_string(sizes.witnesses_size) +
+                " public_inputs_size: " + std::to_string(sizes.public_inputs_size) +
+                " constants_size: " + std::to_string(sizes.constants_size) +
+                " selectors_size: " + std::to_string(sizes.selectors_size) +
+                " max_size: " + std::to_string(sizes.max_size) + "\n";
+    }
+
+    void append_table_row(std::string &line, std::size_t row) const {
+        const table_sizes &sizes = params.sizes;
+        std::size_t gate = enabled_gate(row);
+        for (std::size_t i = 0; i < sizes.witnesses_size; i++) {
+            append_hex(line, integral_type(witness_value(row, i, gate).data));
+            line.push_back(' ');
+        }
+        line += "| ";
+        for (std::size_t i = 0; i < sizes.public_inputs_size; i++) {
+            append_hex(line, integral_type(public_input_value(row, i).data));
+            line.push_back(' ');
+        }
+        line += "| ";
+        for (std::size_t i = 0; i < sizes.constants_size; i++) {
+            append_hex(line, integral_type(random_value(row, sizes.witnesses_size + sizes.public_inputs_size + i).data));
+            line.push_back(' ');
+        }
+        line += "|";
+        for (std::size_t i = 0; i < sizes.selectors_size; i++) {
+            line += (i == gate) ? " 1" : " 0";
+        }
+        line.push_back('\n');
+    }
+
+    void append_circuit_header(std::string &line) const {
+        line += "gates_size: " + std::to_string(gates.size()) +
+                " copy_constraints_size: " + std::to_string(copy_constraints.size()) +
+                " lookup_gates_size: 0\n";
+    }
+
+    void append_gate_header(std::string &line, std::size_t gate) const {
+        line += "selector: " + std::to_string(gate) +
+                " constraints_size: " + std::to_string(gates[gate].size()) + "\n";
+    }
+
+    void append_constraint(std::string &line, std::size_t gate, std::size_t constraint_num) const {
+        auto append_variable = [&line](const synthetic_variable &variable) {
+            line += "w_" + std::to_string(variable.column);
+            if (variable.rotation != 0) {
+                line += "_rot(" + std::to_string(variable.rotation) + ")";
+            }
+        };
+        const synthetic_constraint &constraint = gates[gate][constraint_num];
+        append_variable({constraint.output, 0});
+        for (const auto &term : constraint.terms) {
+            line += term.negative ? " + " : " - ";
+            line += std::to_string(term.coeff);
+            for (const auto &variable : term.variables) {
+                line += " * ";
+                append_variable(variable);
+            }
+        }
+        line.push_back('\n');
+    }
+
+    void append_copy_constraint(std::string &line, std::size_t index) const {
+        const synthetic_copy_constraint &constraint = copy_constraints[index];
+        line += "pub_0_abs_rot(" + std::to_string(constraint.source_row) + ") w_" +
+                std::to_string(constraint.target_column) + "_abs_rot(" + std::to_string(constraint.target_row) + ")\n";
+    }
+
+    void write_table(buffered_writer &out) const {
+        std::string line;
+        append_table_header(line);
+        out.write(line);
+        for (std::size_t row = 0; row < params.sizes.max_size; row++) {
+            line.clear();
+            append_table_row(line, row);
+            out.write(line);
+        }
+    }
+
+    void write_circuit(buffered_writer &out) const {
+        std::string line;
+        append_circuit_header(line);
+        for (std::size_t i = 0; i < gates.size(); i++) {
+            append_gate_header(line, i);
+            for (std::size_t j = 0; j < gates[i].size(); j++) {
+                append_constraint(line, i, j);
+            }
+            out.write(line);
+            line.clear();
+        }
+        for (std::size_t i = 0; i < copy_constraints.size(); i++) {
+            append_copy_constraint(line, i);
+        }
+        out.write(line);
+    }
+
+    value_type random_value(std::size_t row, std::size_t column) const {
+        // One bit less than the modulus guarantees that the value is in the field.
+        const std::size_t bits = BlueprintFieldType::modulus_bits - 1;
+        const std::size_t columns = params.sizes.witnesses_size + params.sizes.public_inputs_size +
+                                    params.sizes.constants_size;
+        std::uint64_t counter = (params.seed << 40) ^ (std::uint64_t(row) * columns + column);
+        integral_type result = 0;
+        for (std::size_t i = 0; i < (bits + 63) / 64; i++) {
+            std::uint64_t word = splitmix64(counter * 0x2545F4914F6CDD1Dull + i);
+            std::size_t word_bits = std::min<std::size_t>(64, bits - 64 * i);
+            if (word_bits < 64) {
+                word &= (std::uint64_t(1) << word_bits) - 1;
+            }
+            result = (result << word_bits) | integral_type(word);
+        }
+        return value_type(result);
+    }
+
+    // Value of the cell as append_table_row writes it, columns are indexed as in table_store.
+    value_type table_value(std::size_t row, std::size_t column) const {
+        const table_sizes &sizes = params.sizes;
+        if (column < sizes.witnesses_size) {
+            return witness_value(row, column, enabled_gate(row));
+        }
+        column -= sizes.witnesses_size;
+        if (column < sizes.public_inputs_size) {
+            return public_input_value(row, column);
+        }
+        column -= sizes.public_inputs_size;
+        if (column < sizes.constants_size) {
+            return random_value(row, sizes.witnesses_size + sizes.public_inputs_size + column);
+        }
+        column -= sizes.constants_size;
+        return column == enabled_gate(row) ? value_type::one() : value_type::zero();
+    }
+
+    value_type public_input_value(std::size_t row, std::size_t column) const {
+        return random_value(row, params.sizes.witnesses_size + column);
+    }
+
+    value_type input_value(std::size_t row, std::size_t column) const {
+        auto copy = copy_targets.find(std::make_pair(row, column));
+        if (copy != copy_targets.end()) {
+            const synthetic_copy_constraint &constraint = copy_constraints[copy->second];
+            value_type value = public_input_value(constraint.source_row, 0);
+            return constraint.unsatisfied ? value + value_type::one() : value;
+        }
+        return random_value(row, column);
+    }
+
+    value_type witness_value(std::size_t row, std::size_t column, std::size_t gate) const {
+        if (column < inputs_size || gate == gates.size()) {
+            return input_value(row, column);
+        }
+        const synthetic_constraint &constraint = gates[gate][column - inputs_size];
+        value_type result = value_type::zero();
+        for (const auto &term : constraint.terms) {
+            value_type product = value_type(integral_type(term.coeff));
+            for (const auto &variable : term.variables) {
+                product *= input_value(row + variable.rotation, variable.column);
+            }
+            if (term.negative) {
+                result -= product;
+            } else {
+                result += product;
+            }
+        }
+        if (splitmix64((std::uint64_t(row) << 16) ^ (column + 1) ^ (params.seed << 48)) < unsatisfied_threshold) {
+            result += value_type::one();
+        }
+        return result;
+    }
+
+private:
+    generator_params params;
+    std::size_t inputs_size;
+    std::uint64_t unsatisfied_threshold;
+    std::vector<std::vector<synthetic_constraint>> gates;
+    std::vector<synthetic_copy_constraint> copy_constraints;
+    std::map<std::pair<std::size_t, std::size_t>, std::size_t> copy_targets;
+};
@@ -24,6 +24,7 @@
 
 #include <giomm/menu.h>
 
+#include <glibmm/miscutils.h>
 #include <glibmm/optioncontext.h>
 #include <glibmm/optiongroup.h>
 
@@ -110,12 +111,70 @@ int main(int argc, char* argv[]) {
     bn_entry.set_description("Use BN curve scalar field");
     main_group.add_entry(bn_entry, bn_scalar);
 
+    Glib::OptionGroup table_group("table", "Table", "Loading of tables");
+    viewer_options options;
+    Glib::OptionEntry paged_memory_entry;
+    paged_memory_entry.set_long_name("paged_memory");
+    paged_memory_entry.set_description(
+        "Page tables in from the file, keeping at most this many MiB of values in memory");
+    table_group.add_entry(paged_memory_entry, options.paged_memory);
+
+    Glib::OptionEntry lazy_parsing_entry;
+    lazy_parsing_entry.set_long_name("lazy");
+    lazy_parsing_entry.set_description("Parse table rows as they are viewed, parsing the rest in the background");
+    table_group.add_entry(lazy_parsing_entry, options.lazy_parsing);
+
+    Glib::OptionEntry watch_table_entry;
+    watch_table_entry.set_long_name("watch");
+    watch_table_entry.set_description("Read the table again when its file changes, parsing only the changed rows");
+    table_group.add_entry(watch_table_entry, options.watch_table);
+
+    Glib::ustring shared_table;
+    Glib::OptionEntry shared_table_entry;
+    shared_table_entry.set_long_name("shared_table");
+    shared_table_entry.set_description("Open the table a prover process wrote into this POSIX shared memory segment");
+    table_group.add_entry(shared_table_entry, shared_table);
+
+    Glib::ustring window_rows, window_columns;
+    Glib::OptionEntry window_rows_entry;
+    window_rows_entry.set_long_name("rows");
+    window_rows_entry.set_description("Only load these rows of tables, as in 1000..4999");
+    table_group.add_entry(window_rows_entry, window_rows);
+
+    Glib::OptionEntry window_columns_entry;
+    window_columns_entry.set_long_name("columns");
+    window_columns_entry.set_description("Only load these columns of tables, as in W0..W14,S3");
+    table_group.add_entry(window_columns_entry, window_columns);
+
+    Glib::OptionGroup check_group("check", "Check", "Checking of circuits");
+    std::string result_cache_dir = Glib::build_filename(Glib::get_user_cache_dir(), "excalibur");
+    Glib::OptionEntry result_cache_entry;
+    result_cache_entry.set_long_name("result_cache");
+    result_cache_entry.set_description("Keep check results in this directory and only check changed rows again");
+    check_group.add_entry_filename(result_cache_entry, result_cache_dir);
+
+    bool no_result_cache = false;
+    Glib::OptionEntry no_result_cache_entry;
+    no_result_cache_entry.set_long_name("no_result_cache");
+    no_result_cache_entry.set_description("Check the whole table every time, without keeping the results");
+    check_group.add_entry(no_result_cache_entry, no_result_cache);
+
     // Add the main group to the context
     Glib::OptionContext context;
     context.set_main_group(main_group);
+    context.add_group(table_group);
+    context.add_group(check_group);
     context.set_help_enabled(true);
     context.set_ignore_unknown_options(true);
     context.parse(argc, argv);
+    options.result_cache_dir = no_result_cache ? std::string() : result_cache_dir;
+    options.shared_table = shared_table;
+    options.window_columns = window_columns;
+    if (!window_rows.empty() &&
+            !parse_row_range(window_rows, options.window_first_row, options.window_rows_amount)) {
+        std::cerr << "Error: --rows has to be a row or a range of rows such as 1000..4999." << std::endl;
+        return 1;
+    }
 
     // check that only a single curve is selected
     std::vector<bool> curve_selections = {
@@ -135,30 +194,30 @@ int main(int argc, char* argv[]) {
     }
 
     if (vesta) {
-        return app->make_window_and_run<ExcaliburWindow<vesta_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<vesta_curve_type>>(argc, argv, options);
     }
     if (pallas) {
-        return app->make_window_and_run<ExcaliburWindow<pallas_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<pallas_curve_type>>(argc, argv, options);
     }
     if (bls12_fr_381) {
-        return app->make_window_and_run<ExcaliburWindow<bls12_fr_381_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<bls12_fr_381_curve_type>>(argc, argv, options);
     }
     if (bls12_fq_381) {
-        return app->make_window_and_run<ExcaliburWindow<bls12_fq_381_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<bls12_fq_381_curve_type>>(argc, argv, options);
     }
     if (mnt4) {
-        return app->make_window_and_run<ExcaliburWindow<mnt4_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<mnt4_curve_type>>(argc, argv, options);
     }
     if (mnt6) {
-        return app->make_window_and_run<ExcaliburWindow<mnt6_curve_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<mnt6_curve_type>>(argc, argv, options);
     }
     if (goldilocks64) {
-        return app->make_window_and_run<ExcaliburWindow<goldilocks64_field_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<goldilocks64_field_type>>(argc, argv, options);
     }
     if (bn_base) {
-        return app->make_window_and_run<ExcaliburWindow<bn_base_field_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<bn_base_field_type>>(argc, argv, options);
     }
     if (bn_scalar) {
-        return app->make_window_and_run<ExcaliburWindow<bn_scalar_field_type>>(argc, argv);
+        return app->make_window_and_run<ExcaliburWindow<bn_scalar_field_type>>(argc, argv, options);
     }
 }
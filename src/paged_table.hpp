@@ -0,0 +1,419 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "row_bitset.hpp"
+#include "store.hpp"
+
+// Table file read a page of rows at a time, for tables which do not fit into memory.
+// Opening the file scans it once: the header is parsed, the offset of the first row of every page is recorded,
+// and selectors, which are the last values of a row, are only checked for being zero without being parsed.
+// Modified pages are appended to an anonymous overlay file in the same text format and read from there afterwards,
+// the table file itself is never written to.
+template<typename BlueprintFieldType>
+class text_page_source : public table_page_source<BlueprintFieldType> {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+
+    static constexpr std::size_t page_rows = table_store<BlueprintFieldType>::block_rows;
+
+    // Throws std::runtime_error if the file can not be read or its layout is broken.
+    explicit text_page_source(const std::string &path) : file(nullptr), overlay(nullptr) {
+        file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        try {
+            scan();
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+    }
+
+    ~text_page_source() override {
+        std::fclose(file);
+        if (overlay != nullptr) {
+            std::fclose(overlay);
+        }
+    }
+
+    text_page_source(const text_page_source&) = delete;
+    text_page_source& operator=(const text_page_source&) = delete;
+
+    const table_sizes& get_sizes() const {
+        return sizes;
+    }
+
+    std::size_t get_pages_amount() const {
+        return page_offsets.size() - 1;
+    }
+
+    // Offset of the first row of the page in the file, the offset past the last row for get_pages_amount().
+    std::uint64_t get_page_offset(std::size_t page) const {
+        return page_offsets[page];
+    }
+
+    // Bitmaps are moved out, the source does not need them.
+    std::vector<row_bitset> take_selector_bitmaps() {
+        return std::move(selector_bitmaps);
+    }
+
+    void read_page(std::size_t page, std::vector<cell_type> &values) override {
+        if (overlay_pages[page].second == 0) {
+            read_file_page(page, values);
+            return;
+        }
+        std::string text;
+        read_range(overlay, overlay_pages[page].first, overlay_pages[page].second, text);
+        parse_page(text, page, values);
+    }
+
+    // Reads the page as it is in the table file, ignoring modifications. Can be called from any thread.
+    void read_file_page(std::size_t page, std::vector<cell_type> &values) const {
+        std::string text;
+        read_range(file, page_offsets[page], page_offsets[page + 1] - page_offsets[page], text);
+        parse_page(text, page, values);
+    }
+
+    void write_page(std::size_t page, const std::vector<cell_type> &values) override {
+        if (overlay == nullptr) {
+            overlay = std::tmpfile();
+            if (overlay == nullptr) {
+                throw std::runtime_error("Failed to create the overlay file for modified rows");
+            }
+        }
+        const std::size_t columns_amount = get_columns_amount();
+        const std::size_t selectors_start = columns_amount - sizes.selectors_size;
+        std::stringstream text;
+        text << std::hex;
+        for (std::size_t i = 0; i < values.size() / columns_amount; i++) {
+            for (std::size_t column = 0; column < columns_amount; column++) {
+                if (column == sizes.witnesses_size || column == sizes.witnesses_size + sizes.public_inputs_size ||
+                    column == selectors_start) {
+                    text << "| ";
+                }
+                text << traits::printable(values[i * columns_amount + column]) << " ";
+            }
+            text << "\n";
+        }
+        const std::string data = text.str();
+        // Rewritten pages are appended, the space taken by their older versions is not reused.
+        if (fseeko(overlay, 0, SEEK_END) != 0) {
+            throw std::runtime_error("Failed to write into the overlay file");
+        }
+        const std::uint64_t offset = ftello(overlay);
+        if (std::fwrite(data.data(), 1, data.size(), overlay) != data.size() || std::fflush(overlay) != 0) {
+            throw std::runtime_error("Failed to write into the overlay file");
+        }
+        overlay_pages[page] = std::make_pair(offset, std::uint64_t(data.size()));
+    }
+
+private:
+    std::size_t get_columns_amount() const {
+        return sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + sizes.selectors_size;
+    }
+
+    // pread does not move the file position, so reads from several threads do not interfere.
+    static void read_range(std::FILE* from, std::uint64_t offset, std::uint64_t size, std::string &out) {
+        out.resize(size);
+        std::size_t done = 0;
+        while (done < size) {
+            const ssize_t read = pread(fileno(from), out.data() + done, size - done, offset + done);
+            if (read <= 0) {
+                throw std::runtime_error("Failed to read the table file");
+            }
+            done += read;
+        }
+    }
+
+    void parse_page(const std::string &text, std::size_t page, std::vector<cell_type> &values) const {
+        const std::size_t columns_amount = get_columns_amount();
+        table_row_parser<std::string::const_iterator, BlueprintFieldType> row_parser(sizes);
+        std::vector<typename traits::parsed_type> row;
+        auto line_begin = text.cbegin();
+        for (std::size_t i = 0; i < values.size() / columns_amount; i++) {
+            auto line_end = std::find(line_begin, text.cend(), '\n');
+            row.clear();
+            bool r = boost::spirit::qi::phrase_parse(line_begin, line_end, row_parser, boost::spirit::ascii::space,
+                                                     row);
+            if (!r || line_begin != line_end) {
+                throw std::runtime_error("Failed to parse row " + std::to_string(page * page_rows + i));
+            }
+            for (std::size_t column = 0; column < columns_amount; column++) {
+                values[i * columns_amount + column] = traits::from_parsed(row[column]);
+            }
+            line_begin = line_end == text.cend() ? line_end : line_end + 1;
+        }
+    }
+
+    // Selectors are usually 0 or 1, so a value is checked for being zero by its digits.
+    static bool is_zero_token(const char* begin, const char* end) {
+        for (const char* c = begin; c != end; c++) {
+            if (*c != '0') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void scan_row(const char* begin, const char* end, std::size_t row) {
+        const char* token_end = end;
+        for (std::size_t i = sizes.selectors_size; i > 0; i--) {
+            while (token_end != begin && std::isspace(static_cast<unsigned char>(token_end[-1]))) {
+                token_end--;
+            }
+            const char* token_begin = token_end;
+            while (token_begin != begin && !std::isspace(static_cast<unsigned char>(token_begin[-1])) &&
+                   token_begin[-1] != '|') {
+                token_begin--;
+            }
+            if (token_begin == token_end) {
+                throw std::runtime_error("Row " + std::to_string(row) + " has too few values");
+            }
+            if (!is_zero_token(token_begin, token_end)) {
+                selector_bitmaps[i - 1].set(row, true);
+            }
+            token_end = token_begin;
+        }
+    }
+
+    void scan() {
+        const std::size_t chunk_size = 1 << 22;
+        std::vector<char> chunk(chunk_size);
+        // Part of a line left over from the previous chunk.
+        std::string carry;
+        // Offsets of the chunk and of the current line in the file.
+        std::uint64_t chunk_offset = 0, line_offset = 0, rows_end = 0;
+        bool header_read = false;
+        std::size_t row = 0;
+
+        // next_offset is where the line after this one starts.
+        auto process_line = [&](const char* begin, const char* end, std::uint64_t next_offset) {
+            if (!header_read) {
+                std::string header(begin, end);
+                auto header_begin = header.begin();
+                table_sizes_parser<std::string::iterator> sizes_parser;
+                bool r = boost::spirit::qi::phrase_parse(header_begin, header.end(), sizes_parser,
+                                                         boost::spirit::ascii::space, sizes);
+                if (!r || header_begin != header.end()) {
+                    throw std::runtime_error("Failed to parse the header line");
+                }
+                header_read = true;
+                selector_bitmaps.assign(sizes.selectors_size, row_bitset(sizes.max_size));
+                page_offsets.reserve((sizes.max_size + page_rows - 1) / page_rows + 1);
+                return;
+            }
+            if (row >= sizes.max_size) {
+                return;
+            }
+            if (row % page_rows == 0) {
+                page_offsets.push_back(line_offset);
+            }
+            scan_row(begin, end, row);
+            row++;
+            rows_end = next_offset;
+        };
+
+        std::size_t read;
+        while ((read = std::fread(chunk.data(), 1, chunk_size, file)) != 0) {
+            const char* begin = chunk.data();
+            const char* end = begin + read;
+            while (begin != end) {
+                const char* newline = std::find(begin, end, '\n');
+                if (newline == end) {
+                    carry.append(begin, end);
+                    break;
+                }
+                const std::uint64_t next_offset = chunk_offset + (newline + 1 - chunk.data());
+                if (carry.empty()) {
+                    process_line(begin, newline, next_offset);
+                } else {
+                    carry.append(begin, newline);
+                    process_line(carry.data(), carry.data() + carry.size(), next_offset);
+                    carry.clear();
+                }
+                begin = newline + 1;
+                line_offset = next_offset;
+            }
+            chunk_offset += read;
+        }
+        if (!carry.empty()) {
+            process_line(carry.data(), carry.data() + carry.size(), chunk_offset);
+        }
+        if (!header_read || row < sizes.max_size) {
+            throw std::runtime_error("The table file is shorter than its header says");
+        }
+        page_offsets.push_back(rows_end);
+        overlay_pages.assign(get_pages_amount(), std::make_pair(std::uint64_t(0), std::uint64_t(0)));
+    }
+
+    std::FILE* file;
+    std::FILE* overlay;
+    table_sizes sizes;
+    std::vector<std::uint64_t> page_offsets;
+    std::vector<row_bitset> selector_bitmaps;
+    // Offset and size of the latest version of every modified page in the overlay file, size 0 if not modified.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> overlay_pages;
+};
+
+// Parses the pages of a text table on worker threads, in order, so that a store which reads the pages lazily
+// is filled in over time. The store itself is not touched here: parsed pages wait in a bounded queue until
+// the thread owning the store takes them with take_ready_pages and installs them.
+template<typename BlueprintFieldType>
+class background_page_loader {
+public:
+    using cell_type = typename field_traits<BlueprintFieldType>::cell_type;
+    using source_type = text_page_source<BlueprintFieldType>;
+
+    // on_ready is called from the worker threads after a page has been queued.
+    background_page_loader(const std::shared_ptr<source_type> &source_, std::size_t threads_amount,
+                           std::size_t max_ready_pages_, std::function<void()> on_ready_)
+        : source(source_), max_ready_pages(std::max<std::size_t>(1, max_ready_pages_)),
+          on_ready(std::move(on_ready_)), next_page(0), stopped(false), pages_done(0), failed(false) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(1, threads_amount); i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~background_page_loader() {
+        stop();
+    }
+
+    background_page_loader(const background_page_loader&) = delete;
+    background_page_loader& operator=(const background_page_loader&) = delete;
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        space_available.notify_all();
+        for (auto &worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    // Calls fn(page, values) for every page parsed since the last call. Returns the amount of pages.
+    template<typename Func>
+    std::size_t take_ready_pages(Func fn) {
+        std::deque<std::pair<std::size_t, std::vector<cell_type>>> pages;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pages.swap(ready_pages);
+        }
+        space_available.notify_all();
+        for (auto &page : pages) {
+            fn(page.first, page.second);
+        }
+        pages_done += pages.size();
+        return pages.size();
+    }
+
+    // All the pages were parsed and taken, or parsing has failed.
+    bool is_finished() const {
+        return failed || pages_done == source->get_pages_amount();
+    }
+
+    // Set if a worker failed to parse a page, the rest is left to be read lazily.
+    bool has_failed() const {
+        return failed;
+    }
+
+private:
+    void work() {
+        const table_sizes &sizes = source->get_sizes();
+        const std::size_t columns_amount =
+            sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + sizes.selectors_size;
+        const std::size_t rows_amount = sizes.max_size;
+        while (true) {
+            const std::size_t page = next_page++;
+            if (page >= source->get_pages_amount()) {
+                return;
+            }
+            const std::size_t page_rows = std::min(source_type::page_rows, rows_amount - page * source_type::page_rows);
+            std::vector<cell_type> values(page_rows * columns_amount);
+            try {
+                source->read_file_page(page, values);
+            } catch (const std::exception &) {
+                failed = true;
+                next_page = source->get_pages_amount();
+                if (on_ready) {
+                    on_ready();
+                }
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space_available.wait(lock, [this]() { return stopped || ready_pages.size() < max_ready_pages; });
+                if (stopped) {
+                    return;
+                }
+                ready_pages.emplace_back(page, std::move(values));
+            }
+            if (on_ready) {
+                on_ready();
+            }
+        }
+    }
+
+    std::shared_ptr<source_type> source;
+    const std::size_t max_ready_pages;
+    std::function<void()> on_ready;
+    std::atomic<std::size_t> next_page;
+    std::mutex mutex;
+    std::condition_variable space_available;
+    std::deque<std::pair<std::size_t, std::vector<cell_type>>> ready_pages;
+    bool stopped;
+    // Only changed by the thread taking the pages.
+    std::size_t pages_done;
+    std::atomic<bool> failed;
+    std::vector<std::thread> workers;
+};
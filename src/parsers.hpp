@@ -33,6 +33,8 @@
 #include <nil/crypto3/zk/math/expression.hpp>
 #include <nil/crypto3/zk/snark/arithmetization/plonk/variable.hpp>
 
+#include "field_traits.hpp"
+
 struct table_sizes {
     uint32_t witnesses_size,
              public_inputs_size,
@@ -139,8 +141,10 @@ struct table_sizes_parser : boost::spirit::qi::grammar<Iterator, table_sizes(),
     boost::spirit::qi::rule<Iterator, table_sizes(), boost::spirit::qi::ascii::space_type> start;
 };
 
+// Fields with small moduli are parsed straight into machine words, see field_traits.
 template<typename Iterator, typename BlueprintFieldType>
-struct table_row_parser : boost::spirit::qi::grammar<Iterator, std::vector<typename BlueprintFieldType::integral_type>,
+struct table_row_parser : boost::spirit::qi::grammar<Iterator,
+                                                    std::vector<typename field_traits<BlueprintFieldType>::parsed_type>,
                                                     boost::spirit::qi::ascii::space_type> {
     table_row_parser(table_sizes sizes) : table_row_parser::base_type(start) {
         using boost::spirit::qi::lit;
@@ -150,7 +154,7 @@ struct table_row_parser : boost::spirit::qi::grammar<Iterator, std::vector<typen
         using boost::phoenix::val;
         using boost::phoenix::construct;
 
-        auto hex_rule = uint_parser<typename BlueprintFieldType::integral_type, 16, 1,
+        auto hex_rule = uint_parser<typename field_traits<BlueprintFieldType>::parsed_type, 16, 1,
                                     (BlueprintFieldType::modulus_bits + 4 - 1) / 4>();
         start = repeat(sizes.witnesses_size)[hex_rule] > lit('|') >
                 repeat(sizes.public_inputs_size)[hex_rule] > lit('|') >
@@ -164,7 +168,7 @@ struct table_row_parser : boost::spirit::qi::grammar<Iterator, std::vector<typen
         );
     }
 
-    boost::spirit::qi::rule<Iterator, std::vector<typename BlueprintFieldType::integral_type>,
+    boost::spirit::qi::rule<Iterator, std::vector<typename field_traits<BlueprintFieldType>::parsed_type>,
                             boost::spirit::qi::ascii::space_type> start;
 };
 
@@ -0,0 +1,376 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "store.hpp"
+
+// Queue between the stages of a pipeline. push blocks while the queue is full, so a producer
+// which is faster than its consumers waits for them instead of piling up data.
+template<typename T>
+class bounded_queue {
+public:
+    explicit bounded_queue(std::size_t capacity_) : capacity(std::max<std::size_t>(1, capacity_)), closed(false) {}
+
+    // Returns false if the queue was closed, the item is dropped then.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Waits for an item, returns false once the queue is closed and empty.
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Nothing more can be pushed, the items already queued can still be popped.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    // Closes the queue and drops the queued items, for when the pipeline is stopped early.
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        items.clear();
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    const std::size_t capacity;
+    std::mutex mutex;
+    std::condition_variable not_empty, not_full;
+    std::deque<T> items;
+    bool closed;
+};
+
+// Reads a table from a stream with one reader and several parser threads, so that reading and parsing overlap.
+// The calling thread reads the input into buffers cut at row block boundaries, the parsers fill the row blocks
+// of the store in parallel. Buffers go around a ring of a fixed amount of them, which bounds the memory used.
+// Meant for inputs without random access, like pipes, decompressed or remote streams.
+template<typename BlueprintFieldType>
+class pipelined_table_reader {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+    using store_type = table_store<BlueprintFieldType>;
+
+    // buffers_amount is the size of the ring, 0 picks two buffers per parser thread.
+    pipelined_table_reader(std::size_t threads_amount_, std::size_t buffer_size_ = 1 << 22,
+                           std::size_t buffers_amount_ = 0)
+        : threads_amount(std::max<std::size_t>(1, threads_amount_)),
+          buffer_size(std::max<std::size_t>(1 << 12, buffer_size_)),
+          buffers_amount(buffers_amount_ == 0 ? 2 * threads_amount + 1 : std::max<std::size_t>(2, buffers_amount_)) {}
+
+    // read(data, size) stores up to size bytes into data and returns how many, 0 at the end of the input.
+    // Throws std::runtime_error if the input is not a valid table, errors thrown by read are passed through.
+    template<typename ReadFunc>
+    std::shared_ptr<store_type> read(ReadFunc read) {
+        std::vector<char> data(buffer_size);
+        std::size_t used = 0;
+        const std::size_t header_end = read_header(read, data, used);
+        auto store = std::make_shared<store_type>(sizes);
+
+        bounded_queue<chunk> filled(buffers_amount), free(buffers_amount);
+        for (std::size_t i = 1; i < buffers_amount; i++) {
+            free.push(chunk());
+        }
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto fail = [&](std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = e;
+            }
+            filled.cancel();
+            free.cancel();
+        };
+
+        std::vector<std::thread> parsers;
+        for (std::size_t t = 0; t < threads_amount; t++) {
+            parsers.emplace_back([&]() {
+                try {
+                    table_row_parser<const char*, BlueprintFieldType> row_parser(sizes);
+                    std::vector<typename traits::parsed_type> row;
+                    std::vector<cell_type> values;
+                    chunk current;
+                    while (filled.pop(current)) {
+                        parse_chunk(current, row_parser, row, values, *store);
+                        free.push(std::move(current));
+                    }
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+            });
+        }
+
+        try {
+            chunk first;
+            first.data = std::move(data);
+            first.used = used;
+            first.begin = header_end;
+            read_rows(read, std::move(first), filled, free);
+            filled.close();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        for (auto &parser : parsers) {
+            parser.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return store;
+    }
+
+private:
+    // Rows [first_row, first_row + rows) are the lines of data[begin, end).
+    struct chunk {
+        std::vector<char> data;
+        std::size_t used = 0;
+        std::size_t begin = 0, end = 0;
+        std::size_t first_row = 0, rows = 0;
+    };
+
+    template<typename ReadFunc>
+    static std::size_t fill(ReadFunc &read, std::vector<char> &data, std::size_t &used) {
+        const std::size_t read_size = read(data.data() + used, data.size() - used);
+        used += read_size;
+        return read_size;
+    }
+
+    // Returns the offset of the first row in data.
+    template<typename ReadFunc>
+    std::size_t read_header(ReadFunc &read, std::vector<char> &data, std::size_t &used) {
+        while (true) {
+            const char* newline = static_cast<const char*>(std::memchr(data.data(), '\n', used));
+            if (newline != nullptr) {
+                const char* header_begin = data.data();
+                table_sizes_parser<const char*> sizes_parser;
+                bool r = boost::spirit::qi::phrase_parse(header_begin, newline, sizes_parser,
+                                                         boost::spirit::ascii::space, sizes);
+                if (!r || header_begin != newline) {
+                    throw std::runtime_error("Failed to parse the header line");
+                }
+                return newline + 1 - data.data();
+            }
+            if (used == data.size()) {
+                throw std::runtime_error("Failed to read the header line");
+            }
+            if (fill(read, data, used) == 0) {
+                throw std::runtime_error("Failed to read the header line");
+            }
+        }
+    }
+
+    // Cuts the input into chunks of whole row blocks, only the last one may be shorter.
+    // A chunk which can not hold a row block yet grows instead.
+    template<typename ReadFunc>
+    void read_rows(ReadFunc &read, chunk current, bounded_queue<chunk> &filled, bounded_queue<chunk> &free) {
+        std::size_t row = 0;
+        // Lines of the current chunk found so far, and where the next one starts.
+        std::size_t rows = 0, scanned = current.begin;
+        bool input_end = false;
+        while (row < sizes.max_size) {
+            std::size_t cut = current.begin;
+            std::size_t cut_rows = 0;
+            // Lines are counted up to the last block boundary in the buffer.
+            while (true) {
+                const char* newline = static_cast<const char*>(
+                    std::memchr(current.data.data() + scanned, '\n', current.used - scanned));
+                if (newline == nullptr) {
+                    break;
+                }
+                scanned = newline + 1 - current.data.data();
+                rows++;
+                if (rows % store_type::block_rows == 0 || row + rows == sizes.max_size) {
+                    cut = scanned;
+                    cut_rows = rows;
+                }
+                if (row + rows == sizes.max_size) {
+                    break;
+                }
+            }
+            // The last row of the input does not have to end with a newline.
+            if (input_end && scanned < current.used && row + rows < sizes.max_size) {
+                scanned = current.used;
+                rows++;
+                if (rows % store_type::block_rows == 0 || row + rows == sizes.max_size) {
+                    cut = scanned;
+                    cut_rows = rows;
+                }
+            }
+            if (cut_rows == 0) {
+                if (input_end) {
+                    throw std::runtime_error("The table file is shorter than its header says");
+                }
+                if (current.used == current.data.size()) {
+                    current.data.resize(current.data.size() * 2);
+                }
+                input_end = fill(read, current.data, current.used) == 0;
+                continue;
+            }
+
+            chunk next;
+            if (!free.pop(next)) {
+                return;
+            }
+            const std::size_t rest = current.used - cut;
+            next.data.resize(std::max(buffer_size, rest + 1));
+            std::memcpy(next.data.data(), current.data.data() + cut, rest);
+            next.used = rest;
+            next.begin = 0;
+            current.end = cut;
+            current.first_row = row;
+            current.rows = cut_rows;
+            row += cut_rows;
+            rows -= cut_rows;
+            scanned -= cut;
+            if (!filled.push(std::move(current))) {
+                return;
+            }
+            current = std::move(next);
+        }
+    }
+
+    void parse_chunk(const chunk &current, const table_row_parser<const char*, BlueprintFieldType> &row_parser,
+                     std::vector<typename traits::parsed_type> &row, std::vector<cell_type> &values,
+                     store_type &store) const {
+        const std::size_t columns_amount = store.get_columns_amount();
+        const char* line_begin = current.data.data() + current.begin;
+        const char* chunk_end = current.data.data() + current.end;
+        for (std::size_t block_start = 0; block_start < current.rows; block_start += store_type::block_rows) {
+            const std::size_t rows_amount = std::min(store_type::block_rows, current.rows - block_start);
+            values.resize(rows_amount * columns_amount);
+            for (std::size_t i = 0; i < rows_amount; i++) {
+                const char* line_end = std::find(line_begin, chunk_end, '\n');
+                row.clear();
+                bool r = boost::spirit::qi::phrase_parse(line_begin, line_end, row_parser,
+                                                         boost::spirit::ascii::space, row);
+                if (!r || line_begin != line_end) {
+                    throw std::runtime_error("Failed to parse row " +
+                                             std::to_string(current.first_row + block_start + i));
+                }
+                for (std::size_t column = 0; column < columns_amount; column++) {
+                    values[i * columns_amount + column] = traits::from_parsed(row[column]);
+                }
+                line_begin = line_end == chunk_end ? line_end : line_end + 1;
+            }
+            store.fill_row_block((current.first_row + block_start) / store_type::block_rows, values);
+        }
+    }
+
+    const std::size_t threads_amount;
+    const std::size_t buffer_size;
+    const std::size_t buffers_amount;
+    table_sizes sizes;
+};
+
+// Splits a stream given by a read function, as taken by pipelined_table_reader, into lines.
+template<typename ReadFunc>
+class line_reader {
+public:
+    explicit line_reader(ReadFunc read_, std::size_t buffer_size = 1 << 20)
+        : read(std::move(read_)), buffer(buffer_size), begin(0), end(0), finished(false) {}
+
+    // Stores the next line without its newline into line, reusing its capacity.
+    // Returns false at the end of the input.
+    bool next(std::string &line) {
+        line.clear();
+        while (true) {
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data() + begin, '\n', end - begin));
+            if (newline != nullptr) {
+                line.append(buffer.data() + begin, newline - (buffer.data() + begin));
+                begin = newline + 1 - buffer.data();
+                return true;
+            }
+            line.append(buffer.data() + begin, end - begin);
+            begin = end = 0;
+            if (finished) {
+                return !line.empty();
+            }
+            end = read(buffer.data(), buffer.size());
+            finished = end == 0;
+        }
+    }
+
+    // Moves past the next line without copying it. Returns false at the end of the input.
+    bool skip() {
+        bool skipped = false;
+        while (true) {
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data() + begin, '\n', end - begin));
+            if (newline != nullptr) {
+                begin = newline + 1 - buffer.data();
+                return true;
+            }
+            skipped = skipped || begin != end;
+            begin = end = 0;
+            if (finished) {
+                return skipped;
+            }
+            end = read(buffer.data(), buffer.size());
+            finished = end == 0;
+        }
+    }
+
+private:
+    ReadFunc read;
+    std::vector<char> buffer;
+    std::size_t begin, end;
+    bool finished;
+};
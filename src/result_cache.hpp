@@ -0,0 +1,346 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "circuit.hpp"
+#include "diff.hpp"
+#include "evaluator.hpp"
+#include "expression_dag.hpp"
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "snapshot.hpp"
+#include "store.hpp"
+
+// Results of full checks are kept on disk between runs, one file per circuit. The file holds the stable hash
+// of every row block of the table last checked against the circuit, together with what the check found
+// at the rows of that block. Checking a table again only evaluates the gates applied at rows whose cells,
+// at any rotation, lie in row blocks with a different hash.
+
+constexpr std::uint32_t result_cache_version = 1;
+constexpr char result_cache_magic[8] = {'E', 'X', 'C', 'C', 'H', 'K', '\0', '\0'};
+
+struct result_cache_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t modulus_bits;
+    table_sizes table;
+    std::uint32_t padding;
+    std::uint64_t circuit_hash;
+    std::uint64_t row_blocks;
+    std::uint64_t failures_amount;
+    // Of everything after the header.
+    std::uint64_t content_hash;
+};
+
+struct cached_row_block {
+    std::uint64_t hash;
+    // Of the gates applied at the rows of the block.
+    std::uint64_t evaluations;
+    std::uint64_t out_of_table_rows;
+};
+
+struct cached_check_stats {
+    std::size_t row_blocks = 0;
+    // Row blocks whose results were taken from the cache.
+    std::size_t reused_row_blocks = 0;
+};
+
+// Hash of the gates of a compiled circuit, stable across runs. Copy constraints are not checked, so they are left out.
+template<typename BlueprintFieldType>
+std::uint64_t get_circuit_hash(const circuit_container<BlueprintFieldType> &circuit,
+                               const expression_dag<BlueprintFieldType> &dag) {
+    using traits = field_traits<BlueprintFieldType>;
+
+    stable_hash hash;
+    hash.add(BlueprintFieldType::modulus_bits);
+    for (const auto &node : dag.get_nodes()) {
+        hash.add(std::uint64_t(node.kind));
+        hash.add(node.left);
+        hash.add(node.right);
+    }
+    std::uint64_t limbs[traits::limbs_amount];
+    for (const auto &constant : dag.get_constants()) {
+        traits::to_limbs(traits::from_value(constant), limbs);
+        for (std::uint64_t limb : limbs) {
+            hash.add(limb);
+        }
+    }
+    for (const auto &variable : dag.get_variables()) {
+        hash.add(variable.index);
+        hash.add(std::uint64_t(std::int64_t(variable.rotation)));
+        hash.add((std::uint64_t(variable.type) << 1) | std::uint64_t(variable.relative));
+    }
+    for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+        hash.add(circuit.gates[i].selector_index);
+        hash.add(circuit.gates[i].constraints.size());
+        for (std::size_t j = 0; j < circuit.gates[i].constraints.size(); j++) {
+            hash.add(dag.get_root(i, j));
+        }
+    }
+    return hash.get();
+}
+
+// Hashes of the rows [block * block_rows, (block + 1) * block_rows) over all the columns, stable across runs.
+// Zero cells do not contribute.
+template<typename BlueprintFieldType>
+std::vector<std::uint64_t> get_stable_row_block_hashes(const table_store<BlueprintFieldType> &store) {
+    using traits = field_traits<BlueprintFieldType>;
+    using store_type = table_store<BlueprintFieldType>;
+
+    std::vector<std::uint64_t> result(store.get_row_blocks_amount());
+    // Paged stores can only be read from one thread.
+    const std::size_t max_threads = store.is_paged() ? 1 : std::thread::hardware_concurrency();
+    const std::size_t threads_amount = std::max<std::size_t>(1, std::min<std::size_t>(max_threads, result.size()));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        threads.emplace_back([&, t]() {
+            std::uint64_t limbs[traits::limbs_amount];
+            for (std::size_t block = t; block < result.size(); block += threads_amount) {
+                const std::size_t first_row = block * store_type::block_rows;
+                const std::size_t rows = std::min(store_type::block_rows, store.get_rows_amount() - first_row);
+                stable_hash hash;
+                for (std::size_t column = 0; column < store.get_columns_amount(); column++) {
+                    const auto span = store.get_column_span(column);
+                    if (span.blocks != nullptr && span.blocks[block].empty()) {
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < rows; i++) {
+                        const auto cell = span[first_row + i];
+                        if (traits::is_zero(cell)) {
+                            continue;
+                        }
+                        hash.add(column * store_type::block_rows + i);
+                        traits::to_limbs(cell, limbs);
+                        for (std::uint64_t limb : limbs) {
+                            hash.add(limb);
+                        }
+                    }
+                }
+                result[block] = hash.get();
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return result;
+}
+
+// Path of the cache file of the circuit in the directory.
+inline std::string get_result_cache_path(const std::string &directory, std::uint64_t circuit_hash) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.checks", static_cast<unsigned long long>(circuit_hash));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Brings the results of a check of the table up to date after the cells of the row blocks marked as changed
+// were modified. Blocks hold the results of the earlier check at the rows of every row block and are updated,
+// previous_failures are the failures it found. If everything is marked as changed, this is a full check.
+// Returns the new result, failures ordered as by gate_evaluator::check, and sets rechecked_blocks to the number
+// of row blocks whose gates were evaluated again.
+template<typename BlueprintFieldType>
+typename gate_evaluator<BlueprintFieldType>::check_result recheck_row_blocks(
+        const gate_evaluator<BlueprintFieldType> &evaluator, const table_store<BlueprintFieldType> &store,
+        const std::vector<bool> &changed, std::vector<cached_row_block> &blocks,
+        const std::vector<typename gate_evaluator<BlueprintFieldType>::failure> &previous_failures,
+        std::size_t &rechecked_blocks) {
+    using store_type = table_store<BlueprintFieldType>;
+    using check_result = typename gate_evaluator<BlueprintFieldType>::check_result;
+    using failure = typename gate_evaluator<BlueprintFieldType>::failure;
+    constexpr std::size_t block_rows = store_type::block_rows;
+
+    const std::size_t row_blocks = store.get_row_blocks_amount();
+    // A gate applied at row r reads the rows [r + min_rotation, r + max_rotation], so a changed row block
+    // [first, last) affects the gates applied at the rows [first - max_rotation, last - min_rotation).
+    const auto [min_rotation, max_rotation] = evaluator.get_rotation_range();
+    std::vector<bool> recheck(row_blocks, false);
+    for (std::size_t block = 0; block < row_blocks; block++) {
+        if (!changed[block]) {
+            continue;
+        }
+        const std::int64_t first_row = std::int64_t(block * block_rows) - max_rotation;
+        const std::int64_t last_row = std::int64_t(std::min((block + 1) * block_rows, store.get_rows_amount())) -
+                                      min_rotation;
+        const std::size_t first_block = std::max<std::int64_t>(0, first_row) / block_rows;
+        const std::size_t last_block = std::min<std::int64_t>(row_blocks, (last_row + block_rows - 1) / block_rows);
+        for (std::size_t i = first_block; i < last_block; i++) {
+            recheck[i] = true;
+        }
+    }
+
+    std::vector<std::size_t> recheck_blocks;
+    for (std::size_t block = 0; block < row_blocks; block++) {
+        if (recheck[block]) {
+            recheck_blocks.push_back(block);
+        }
+    }
+    rechecked_blocks = recheck_blocks.size();
+
+    check_result result;
+    for (const failure &previous : previous_failures) {
+        if (previous.row < store.get_rows_amount() && !recheck[previous.row / block_rows]) {
+            result.failures.push_back(previous);
+        }
+    }
+    // Paged stores can only be read from one thread.
+    const std::size_t max_threads = store.is_paged() ? 1 : std::thread::hardware_concurrency();
+    const std::size_t threads_amount =
+        std::max<std::size_t>(1, std::min<std::size_t>(max_threads, recheck_blocks.size()));
+    std::vector<std::vector<failure>> thread_failures(threads_amount);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        threads.emplace_back([&, t]() {
+            for (std::size_t i = t; i < recheck_blocks.size(); i += threads_amount) {
+                const std::size_t block = recheck_blocks[i];
+                check_result block_result = evaluator.check_rows(store, block * block_rows, (block + 1) * block_rows);
+                blocks[block].evaluations = block_result.evaluations;
+                blocks[block].out_of_table_rows = block_result.out_of_table_rows;
+                thread_failures[t].insert(thread_failures[t].end(), block_result.failures.begin(),
+                                          block_result.failures.end());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (const auto &failures : thread_failures) {
+        result.failures.insert(result.failures.end(), failures.begin(), failures.end());
+    }
+    std::sort(result.failures.begin(), result.failures.end(), [](const failure &a, const failure &b) {
+        return std::tie(a.gate, a.row, a.constraint_num) < std::tie(b.gate, b.row, b.constraint_num);
+    });
+    for (const cached_row_block &block : blocks) {
+        result.evaluations += block.evaluations;
+        result.out_of_table_rows += block.out_of_table_rows;
+    }
+    return result;
+}
+
+// Checks the table as gate_evaluator::check does, taking the results of unchanged row blocks from the cache
+// in the directory and writing the new results back. A missing or unreadable cache file only means that
+// everything is evaluated. Failures to write the cache are reported to std::cerr.
+// Blocks are set to the results at the rows of every row block.
+template<typename BlueprintFieldType>
+typename gate_evaluator<BlueprintFieldType>::check_result cached_check(
+        const std::string &directory, std::uint64_t circuit_hash, const gate_evaluator<BlueprintFieldType> &evaluator,
+        const table_store<BlueprintFieldType> &store, std::vector<cached_row_block> &blocks,
+        cached_check_stats &stats) {
+    using check_result = typename gate_evaluator<BlueprintFieldType>::check_result;
+    using failure = typename gate_evaluator<BlueprintFieldType>::failure;
+
+    const std::string path = get_result_cache_path(directory, circuit_hash);
+    const table_sizes &sizes = store.get_sizes();
+    const std::size_t row_blocks = store.get_row_blocks_amount();
+    blocks.assign(row_blocks, cached_row_block());
+    const std::vector<std::uint64_t> hashes = get_stable_row_block_hashes(store);
+    stats = cached_check_stats();
+    stats.row_blocks = row_blocks;
+
+    // Row blocks whose cells changed since the cached check, nothing is known if there is no usable cache.
+    std::vector<bool> changed(row_blocks, true);
+    std::vector<failure> cached_failures;
+    try {
+        if (std::filesystem::exists(path)) {
+            mapped_file file(path);
+            result_cache_header header;
+            std::memcpy(&header, file.get_data(), std::min(sizeof(header), file.get_size()));
+            const bool usable =
+                file.get_size() >= sizeof(header) &&
+                std::equal(std::begin(result_cache_magic), std::end(result_cache_magic), header.magic) &&
+                header.version == result_cache_version &&
+                header.modulus_bits == BlueprintFieldType::modulus_bits &&
+                header.circuit_hash == circuit_hash && header.row_blocks == row_blocks &&
+                same_table_sizes(header.table, sizes) &&
+                file.get_size() == sizeof(header) + row_blocks * sizeof(cached_row_block) +
+                                   header.failures_amount * sizeof(failure);
+            if (usable) {
+                const char* data = file.get_data() + sizeof(header);
+                stable_hash content_hash;
+                content_hash.add(data, file.get_size() - sizeof(header));
+                if (content_hash.get() != header.content_hash) {
+                    throw std::runtime_error("The check results cache is corrupted");
+                }
+                std::memcpy(blocks.data(), data, row_blocks * sizeof(cached_row_block));
+                cached_failures.resize(header.failures_amount);
+                std::memcpy(cached_failures.data(), data + row_blocks * sizeof(cached_row_block),
+                            header.failures_amount * sizeof(failure));
+                for (std::size_t block = 0; block < row_blocks; block++) {
+                    changed[block] = blocks[block].hash != hashes[block];
+                }
+            }
+        }
+    } catch (const std::exception &) {
+        cached_failures.clear();
+        std::fill(changed.begin(), changed.end(), true);
+    }
+
+    std::size_t rechecked_blocks = 0;
+    check_result result = recheck_row_blocks(evaluator, store, changed, blocks, cached_failures, rechecked_blocks);
+    stats.reused_row_blocks = row_blocks - rechecked_blocks;
+    for (std::size_t block = 0; block < row_blocks; block++) {
+        blocks[block].hash = hashes[block];
+    }
+
+    // The file is replaced as a whole, so that a concurrent reader never sees it half written.
+    result_cache_header header = {};
+    std::copy(std::begin(result_cache_magic), std::end(result_cache_magic), header.magic);
+    header.version = result_cache_version;
+    header.modulus_bits = BlueprintFieldType::modulus_bits;
+    header.table = sizes;
+    header.circuit_hash = circuit_hash;
+    header.row_blocks = row_blocks;
+    header.failures_amount = result.failures.size();
+    stable_hash content_hash;
+    content_hash.add(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(cached_row_block));
+    content_hash.add(reinterpret_cast<const char*>(result.failures.data()), result.failures.size() * sizeof(failure));
+    header.content_hash = content_hash.get();
+    const std::string temp_path = path + ".tmp";
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    bool written = file != nullptr &&
+                   std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(blocks.data(), sizeof(cached_row_block), row_blocks, file) == row_blocks &&
+                   std::fwrite(result.failures.data(), sizeof(failure), result.failures.size(), file) ==
+                       result.failures.size();
+    if (file != nullptr) {
+        written = std::fclose(file) == 0 && written;
+    }
+    if (!written || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        std::cerr << "Failed to write the check results to " << path << std::endl;
+    }
+    return result;
+}
@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Packed set of row indices, one bit per row.
+class row_bitset {
+public:
+    row_bitset() : bits_size(0) {}
+
+    explicit row_bitset(std::size_t size) : words((size + 63) / 64, 0), bits_size(size) {}
+
+    std::size_t size() const {
+        return bits_size;
+    }
+
+    bool test(std::size_t row) const {
+        return (words[row / 64] >> (row % 64)) & 1;
+    }
+
+    void set(std::size_t row, bool value = true) {
+        const std::uint64_t mask = std::uint64_t(1) << (row % 64);
+        if (value) {
+            words[row / 64] |= mask;
+        } else {
+            words[row / 64] &= ~mask;
+        }
+    }
+
+    void reset() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+
+    std::size_t count() const {
+        std::size_t result = 0;
+        for (std::uint64_t word : words) {
+            result += __builtin_popcountll(word);
+        }
+        return result;
+    }
+
+    // Calls f for every set row in increasing order, empty words are skipped whole.
+    template<typename Func>
+    void for_each_set(Func f) const {
+        for (std::size_t i = 0; i < words.size(); i++) {
+            std::uint64_t word = words[i];
+            while (word != 0) {
+                f(i * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Same as for_each_set, for the rows [first, last) only.
+    template<typename Func>
+    void for_each_set(std::size_t first, std::size_t last, Func f) const {
+        last = std::min(last, bits_size);
+        if (first >= last) {
+            return;
+        }
+        const std::size_t first_word = first / 64, last_word = (last - 1) / 64;
+        for (std::size_t i = first_word; i <= last_word; i++) {
+            std::uint64_t word = words[i];
+            if (i == first_word) {
+                word &= ~std::uint64_t(0) << (first % 64);
+            }
+            if (i == last_word && last % 64 != 0) {
+                word &= (std::uint64_t(1) << (last % 64)) - 1;
+            }
+            while (word != 0) {
+                f(i * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    const std::vector<std::uint64_t>& get_words() const {
+        return words;
+    }
+
+    std::vector<std::uint64_t>& get_words() {
+        return words;
+    }
+
+private:
+    std::vector<std::uint64_t> words;
+    std::size_t bits_size;
+};
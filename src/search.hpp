@@ -0,0 +1,333 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "store.hpp"
+
+// Position of a cell in the store, columns are indexed as in table_store.
+struct cell_position {
+    std::uint32_t row;
+    std::uint32_t column;
+
+    bool operator<(const cell_position &other) const {
+        return row != other.row ? row < other.row : column < other.column;
+    }
+
+    bool operator==(const cell_position &other) const {
+        return row == other.row && column == other.column;
+    }
+};
+
+template<typename BlueprintFieldType>
+struct search_query {
+    using parsed_type = typename field_traits<BlueprintFieldType>::parsed_type;
+
+    enum class kind { exact, range, non_zero };
+
+    kind type = kind::exact;
+    // For exact queries only low is used.
+    parsed_type low = 0;
+    parsed_type high = 0;
+    // Columns to look in, all of them if empty.
+    std::vector<std::size_t> columns;
+};
+
+// Runs fn(column, results) for every column, spreading the columns over at most max_threads threads.
+// Results of the threads are merged and sorted by row, then column.
+template<typename Func>
+std::vector<cell_position> parallel_over_columns(const std::vector<std::size_t> &columns, std::size_t max_threads,
+                                                 Func fn) {
+    const std::size_t threads_amount = std::max<std::size_t>(1, std::min<std::size_t>(max_threads, columns.size()));
+    std::vector<std::vector<cell_position>> thread_results(threads_amount);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        threads.emplace_back([&, t]() {
+            for (std::size_t i = t; i < columns.size(); i += threads_amount) {
+                fn(columns[i], thread_results[t]);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::vector<cell_position> result;
+    for (auto &part : thread_results) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+inline std::string trim_spaces(std::string str) {
+    auto not_space = [](unsigned char c) { return !std::isspace(c); };
+    str.erase(str.begin(), std::find_if(str.begin(), str.end(), not_space));
+    str.erase(std::find_if(str.rbegin(), str.rend(), not_space).base(), str.end());
+    return str;
+}
+
+// Parses a comma separated list of columns named as in the view, e.g. "W0,P1,S3", into store column indices.
+// Ranges of columns of the same kind are written as "W0..W9". Returns false and reports if a name is unknown.
+inline bool parse_column_names(const std::string &text, const table_sizes &sizes, std::vector<std::size_t> &columns) {
+    const std::size_t offsets[] = {
+        0, sizes.witnesses_size, sizes.witnesses_size + sizes.public_inputs_size,
+        sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size};
+    const std::size_t amounts[] = {
+        sizes.witnesses_size, sizes.public_inputs_size, sizes.constants_size, sizes.selectors_size};
+    // Kind is the position in "WPCS", npos if the name is broken.
+    auto parse_name = [&amounts](const std::string &name, std::size_t &kind, std::size_t &index) {
+        const std::string prefixes = "WPCS";
+        kind = name.empty() ? std::string::npos : prefixes.find(std::toupper(name[0]));
+        try {
+            std::size_t parsed = 0;
+            index = kind == std::string::npos ? 0 : std::stoul(name.substr(1), &parsed);
+            if (parsed != name.size() - 1) {
+                kind = std::string::npos;
+            }
+        } catch (const std::exception &) {
+            kind = std::string::npos;
+        }
+        if (kind != std::string::npos && index >= amounts[kind]) {
+            kind = std::string::npos;
+        }
+    };
+
+    std::stringstream columns_stream(text);
+    std::string name;
+    while (std::getline(columns_stream, name, ',')) {
+        name = trim_spaces(name);
+        const auto dots = name.find("..");
+        std::size_t kind, index, last_kind, last_index;
+        parse_name(trim_spaces(name.substr(0, dots)), kind, index);
+        if (dots == std::string::npos) {
+            last_kind = kind;
+            last_index = index;
+        } else {
+            parse_name(trim_spaces(name.substr(dots + 2)), last_kind, last_index);
+        }
+        if (kind == std::string::npos || last_kind != kind || last_index < index) {
+            std::cerr << "Unknown column \"" << name << "\"" << std::endl;
+            return false;
+        }
+        for (std::size_t i = index; i <= last_index; i++) {
+            columns.push_back(offsets[kind] + i);
+        }
+    }
+    return true;
+}
+
+// Query syntax: [columns:] value | low..high | nonzero
+// Values are hex, columns are named as in the view, e.g. "W0,P1,S3: 1f".
+template<typename BlueprintFieldType>
+bool parse_search_query(const std::string &text, const table_sizes &sizes, search_query<BlueprintFieldType> &query) {
+    using parsed_type = typename field_traits<BlueprintFieldType>::parsed_type;
+
+    auto parse_value = [](const std::string &str, parsed_type &value) {
+        std::stringstream ss;
+        ss << std::hex << str;
+        ss >> value;
+        return !ss.fail() && ss.eof();
+    };
+
+    query = search_query<BlueprintFieldType>();
+    std::string value_text = text;
+    auto colon = text.find(':');
+    if (colon != std::string::npos) {
+        if (!parse_column_names(text.substr(0, colon), sizes, query.columns)) {
+            return false;
+        }
+        value_text = text.substr(colon + 1);
+    }
+    value_text = trim_spaces(value_text);
+
+    auto dots = value_text.find("..");
+    if (value_text == "nonzero") {
+        query.type = search_query<BlueprintFieldType>::kind::non_zero;
+    } else if (dots != std::string::npos) {
+        query.type = search_query<BlueprintFieldType>::kind::range;
+        if (!parse_value(trim_spaces(value_text.substr(0, dots)), query.low) ||
+            !parse_value(trim_spaces(value_text.substr(dots + 2)), query.high)) {
+            std::cerr << "Failed to parse the range" << std::endl;
+            return false;
+        }
+    } else {
+        query.type = search_query<BlueprintFieldType>::kind::exact;
+        if (!parse_value(value_text, query.low)) {
+            std::cerr << "Failed to parse the value" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Finds cells matching a search_query. Columns are scanned in parallel, empty blocks of the store
+// are matched as a whole. Exact searches for non-zero values go through a hash index of all non-zero cells,
+// which is built on the first such search and rebuilt when the store changes.
+template<typename BlueprintFieldType>
+class table_search {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+    using store_type = table_store<BlueprintFieldType>;
+
+    void clear() {
+        index.clear();
+        indexed_store = nullptr;
+    }
+
+    // At most max_results positions are returned, the first ones by row.
+    std::vector<cell_position> find(const store_type &store, const search_query<BlueprintFieldType> &query,
+                                    std::size_t max_results) {
+        std::vector<std::size_t> columns = query.columns;
+        if (columns.empty()) {
+            columns.resize(store.get_columns_amount());
+            for (std::size_t i = 0; i < columns.size(); i++) {
+                columns[i] = i;
+            }
+        }
+        std::vector<cell_position> result;
+        if (query.type == search_query<BlueprintFieldType>::kind::exact && query.low != 0) {
+            result = find_indexed(store, traits::from_parsed(query.low), columns);
+        } else {
+            result = parallel_over_columns(columns, get_max_threads(store),
+                                           [&](std::size_t column, std::vector<cell_position> &found) {
+                                               scan_column(store, query, column, max_results, found);
+                                           });
+        }
+        if (result.size() > max_results) {
+            result.resize(max_results);
+        }
+        return result;
+    }
+
+private:
+    // Paged stores can only be read from one thread.
+    static std::size_t get_max_threads(const store_type &store) {
+        return store.is_paged() ? 1 : std::thread::hardware_concurrency();
+    }
+
+    static bool matches(const search_query<BlueprintFieldType> &query, const cell_type &cell) {
+        switch (query.type) {
+            case search_query<BlueprintFieldType>::kind::exact:
+                return cell == traits::from_parsed(query.low);
+            case search_query<BlueprintFieldType>::kind::range: {
+                auto value = traits::to_parsed(cell);
+                return query.low <= value && value <= query.high;
+            }
+            case search_query<BlueprintFieldType>::kind::non_zero:
+                return !traits::is_zero(cell);
+        }
+        return false;
+    }
+
+    // Appends at most max_results positions of the column to found, which may already hold other columns.
+    static void scan_column(const store_type &store, const search_query<BlueprintFieldType> &query,
+                            std::size_t column, std::size_t max_results, std::vector<cell_position> &found) {
+        const std::size_t rows_amount = store.get_rows_amount();
+        const std::size_t limit = found.size() + std::min(max_results, rows_amount);
+        if (store.is_paged()) {
+            for (std::size_t row = 0; row < rows_amount && found.size() < limit; row++) {
+                if (matches(query, store.get_cell(column, row))) {
+                    found.push_back({std::uint32_t(row), std::uint32_t(column)});
+                }
+            }
+            return;
+        }
+        auto span = store.get_column_span(column);
+        const bool zero_matches = matches(query, store_type::zero());
+        for (std::size_t block_start = 0; block_start < rows_amount && found.size() < limit;
+             block_start += store_type::block_rows) {
+            const auto &block = span.blocks[block_start / store_type::block_rows];
+            const std::size_t block_end = std::min(rows_amount, block_start + store_type::block_rows);
+            if (block.empty()) {
+                if (zero_matches) {
+                    for (std::size_t row = block_start; row < block_end && found.size() < limit; row++) {
+                        found.push_back({std::uint32_t(row), std::uint32_t(column)});
+                    }
+                }
+                continue;
+            }
+            for (std::size_t row = block_start; row < block_end; row++) {
+                if (matches(query, block[row - block_start])) {
+                    found.push_back({std::uint32_t(row), std::uint32_t(column)});
+                }
+            }
+        }
+    }
+
+    std::vector<cell_position> find_indexed(const store_type &store, const cell_type &value,
+                                            const std::vector<std::size_t> &columns) {
+        if (indexed_store != &store || indexed_version != store.get_version()) {
+            build_index(store);
+        }
+        std::vector<cell_position> result;
+        auto it = index.find(traits::hash(value));
+        if (it == index.end()) {
+            return result;
+        }
+        std::vector<bool> wanted(store.get_columns_amount(), false);
+        for (std::size_t column : columns) {
+            wanted[column] = true;
+        }
+        for (const cell_position &position : it->second) {
+            if (wanted[position.column] && store.get_cell(position.column, position.row) == value) {
+                result.push_back(position);
+            }
+        }
+        return result;
+    }
+
+    void build_index(const store_type &store) {
+        index.clear();
+        std::vector<std::size_t> columns(store.get_columns_amount());
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            columns[i] = i;
+        }
+        search_query<BlueprintFieldType> non_zero;
+        non_zero.type = search_query<BlueprintFieldType>::kind::non_zero;
+        auto cells = parallel_over_columns(columns, get_max_threads(store),
+                                           [&](std::size_t column, std::vector<cell_position> &found) {
+                                               scan_column(store, non_zero, column, store.get_rows_amount(), found);
+                                           });
+        for (const cell_position &position : cells) {
+            index[traits::hash(store.get_cell(position.column, position.row))].push_back(position);
+        }
+        indexed_store = &store;
+        indexed_version = store.get_version();
+    }
+
+    std::unordered_map<std::uint64_t, std::vector<cell_position>> index;
+    const store_type* indexed_store = nullptr;
+    std::uint64_t indexed_version = 0;
+};
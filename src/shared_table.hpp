@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "row_bitset.hpp"
+#include "store.hpp"
+
+// Tables handed over by a prover process running on the same machine through a POSIX shared memory segment,
+// without writing and parsing them as text.
+//
+// The segment starts with shared_table_header, the values follow at data_offset, column after column in the order
+// of table_store: witnesses, public inputs, constants and selectors. Every column has max_size cells,
+// and every cell is limbs_amount little-endian 64-bit limbs of its value, the same limbs field_traits::to_limbs
+// gives. The producer sets ready once all the values are written, readers refuse segments which are not ready.
+
+constexpr std::uint32_t shared_table_version = 1;
+constexpr char shared_table_magic[8] = {'E', 'X', 'C', 'S', 'H', 'M', '\0', '\0'};
+
+struct shared_table_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t modulus_bits;
+    std::uint32_t limbs_amount;
+    table_sizes sizes;
+    std::atomic<std::uint32_t> ready;
+    std::uint64_t data_offset;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "The ready flag is shared between processes, it has to be lock-free");
+
+// Values start at a page boundary of the segment.
+constexpr std::uint64_t shared_table_data_offset = 4096;
+
+inline std::uint64_t get_shared_table_size(const table_sizes &sizes, std::size_t limbs_amount) {
+    const std::uint64_t columns_amount = std::uint64_t(sizes.witnesses_size) + sizes.public_inputs_size +
+                                         sizes.constants_size + sizes.selectors_size;
+    return shared_table_data_offset + columns_amount * sizes.max_size * limbs_amount * sizeof(std::uint64_t);
+}
+
+// Writes a table into a new shared memory segment, replacing a segment of the same name.
+// The segment outlives the writer, it is removed with unlink or by the system on reboot.
+template<typename BlueprintFieldType>
+class shared_table_writer {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+
+    // Names are of the form "/name", see shm_open. Throws std::runtime_error if the segment can not be created.
+    shared_table_writer(const std::string &name_, const table_sizes &sizes_) : name(name_), sizes(sizes_) {
+        size = get_shared_table_size(sizes, traits::limbs_amount);
+        ::shm_unlink(name.c_str());
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create the shared memory segment " + name);
+        }
+        if (::ftruncate(fd, size) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to allocate the shared memory segment " + name);
+        }
+        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to map the shared memory segment " + name);
+        }
+        data = static_cast<char*>(mapping);
+        // The segment is zero-filled, so the header only needs the non-zero fields and cells default to zero.
+        header = new (data) shared_table_header();
+        std::copy(std::begin(shared_table_magic), std::end(shared_table_magic), header->magic);
+        header->version = shared_table_version;
+        header->modulus_bits = BlueprintFieldType::modulus_bits;
+        header->limbs_amount = traits::limbs_amount;
+        header->sizes = sizes;
+        header->data_offset = shared_table_data_offset;
+    }
+
+    ~shared_table_writer() {
+        ::munmap(data, size);
+    }
+
+    shared_table_writer(const shared_table_writer&) = delete;
+    shared_table_writer& operator=(const shared_table_writer&) = delete;
+
+    // Columns are indexed as in table_store.
+    void set(std::size_t column, std::size_t row, const cell_type &value) {
+        traits::to_limbs(value, get_column(column) + row * traits::limbs_amount);
+    }
+
+    // Limbs of the cells of the column, for producers which write them directly.
+    std::uint64_t* get_column(std::size_t column) {
+        return reinterpret_cast<std::uint64_t*>(data + shared_table_data_offset) +
+               column * sizes.max_size * traits::limbs_amount;
+    }
+
+    // Makes the table visible to readers, nothing may be written after this.
+    void publish() {
+        header->ready.store(1, std::memory_order_release);
+    }
+
+    static void unlink(const std::string &name) {
+        ::shm_unlink(name.c_str());
+    }
+
+private:
+    std::string name;
+    table_sizes sizes;
+    std::uint64_t size;
+    char* data;
+    shared_table_header* header;
+};
+
+// Read-only mapping of a shared table segment. Cells are converted from their limbs as row blocks are read,
+// so a table store paged from it never holds a copy of the values it did not access, and the view of the table
+// is built without touching the values at all. Modified row blocks are kept in memory, the segment is never written.
+template<typename BlueprintFieldType>
+class shared_page_source : public table_page_source<BlueprintFieldType> {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+
+    static constexpr std::size_t page_rows = table_store<BlueprintFieldType>::block_rows;
+
+    // Throws std::runtime_error if the segment does not exist, is not ready or does not hold a table of the field.
+    explicit shared_page_source(const std::string &name) : data(nullptr), size(0) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open the shared memory segment " + name);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || std::uint64_t(info.st_size) < sizeof(shared_table_header)) {
+            ::close(fd);
+            throw std::runtime_error("The shared memory segment " + name + " does not hold a table");
+        }
+        size = info.st_size;
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Failed to map the shared memory segment " + name);
+        }
+        data = static_cast<const char*>(mapping);
+        try {
+            validate(name);
+        } catch (...) {
+            ::munmap(const_cast<char*>(data), size);
+            throw;
+        }
+    }
+
+    ~shared_page_source() override {
+        ::munmap(const_cast<char*>(data), size);
+    }
+
+    shared_page_source(const shared_page_source&) = delete;
+    shared_page_source& operator=(const shared_page_source&) = delete;
+
+    const table_sizes& get_sizes() const {
+        return sizes;
+    }
+
+    std::size_t get_pages_amount() const {
+        return (sizes.max_size + page_rows - 1) / page_rows;
+    }
+
+    // Limbs of the cells of the column as the producer wrote them.
+    const std::uint64_t* get_column(std::size_t column) const {
+        return reinterpret_cast<const std::uint64_t*>(data + shared_table_data_offset) +
+               column * sizes.max_size * traits::limbs_amount;
+    }
+
+    // Only the selector columns are read.
+    std::vector<row_bitset> get_selector_bitmaps() const {
+        std::vector<row_bitset> result(sizes.selectors_size, row_bitset(sizes.max_size));
+        const std::size_t selectors_start = get_columns_amount() - sizes.selectors_size;
+        for (std::size_t i = 0; i < sizes.selectors_size; i++) {
+            const std::uint64_t* limbs = get_column(selectors_start + i);
+            for (std::size_t row = 0; row < sizes.max_size; row++) {
+                if (!traits::is_zero(traits::from_limbs(limbs + row * traits::limbs_amount))) {
+                    result[i].set(row, true);
+                }
+            }
+        }
+        return result;
+    }
+
+    void read_page(std::size_t page, std::vector<cell_type> &values) override {
+        auto modified = modified_pages.find(page);
+        if (modified != modified_pages.end()) {
+            values = modified->second;
+            return;
+        }
+        const std::size_t columns_amount = get_columns_amount();
+        const std::size_t first_row = page * page_rows;
+        const std::size_t rows = values.size() / columns_amount;
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            const std::uint64_t* limbs = get_column(column) + first_row * traits::limbs_amount;
+            for (std::size_t i = 0; i < rows; i++) {
+                values[i * columns_amount + column] = traits::from_limbs(limbs + i * traits::limbs_amount);
+            }
+        }
+    }
+
+    void write_page(std::size_t page, const std::vector<cell_type> &values) override {
+        modified_pages[page] = values;
+    }
+
+private:
+    std::size_t get_columns_amount() const {
+        return sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + sizes.selectors_size;
+    }
+
+    void validate(const std::string &name) {
+        const shared_table_header* header = reinterpret_cast<const shared_table_header*>(data);
+        if (!std::equal(std::begin(shared_table_magic), std::end(shared_table_magic), header->magic) ||
+            header->version != shared_table_version) {
+            throw std::runtime_error("The shared memory segment " + name + " does not hold a table of this version");
+        }
+        if (header->modulus_bits != BlueprintFieldType::modulus_bits ||
+            header->limbs_amount != traits::limbs_amount) {
+            throw std::runtime_error("The table in the shared memory segment " + name + " is of another field");
+        }
+        if (header->ready.load(std::memory_order_acquire) == 0) {
+            throw std::runtime_error("The table in the shared memory segment " + name + " is not written yet");
+        }
+        sizes = header->sizes;
+        if (header->data_offset != shared_table_data_offset ||
+            size < get_shared_table_size(sizes, traits::limbs_amount)) {
+            throw std::runtime_error("The shared memory segment " + name + " is smaller than its table");
+        }
+    }
+
+    const char* data;
+    std::uint64_t size;
+    table_sizes sizes;
+    // Row-major values of the row blocks modified in the store.
+    std::unordered_map<std::size_t, std::vector<cell_type>> modified_pages;
+};
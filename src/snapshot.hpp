@@ -0,0 +1,802 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "circuit.hpp"
+#include "constraint_index.hpp"
+#include "evaluator.hpp"
+#include "expression_dag.hpp"
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "store.hpp"
+
+// A session snapshot keeps everything derived from a table file and a circuit file: the table values and
+// selector bitmaps, the expression DAG the circuit was compiled into, the constraint index and the result
+// of the last check. Reopening one is copying memory instead of parsing text and building the caches again.
+//
+// The file is a header followed by sections, each aligned to 64 bytes, so that the file can be mapped and
+// the sections used in place. Numbers are in the byte order of the machine which wrote the snapshot.
+// Any change of the layout has to bump snapshot_version.
+
+constexpr std::uint32_t snapshot_version = 1;
+
+// 64-bit hash which, unlike field_traits::hash, is stable across builds and can be kept in files.
+// Data may be added in pieces of any sizes, the result only depends on the concatenated bytes.
+class stable_hash {
+public:
+    void add(std::uint64_t word) {
+        if (pending_size != 0) {
+            add(reinterpret_cast<const char*>(&word), 8);
+            return;
+        }
+        mix(word);
+    }
+
+    void add(const char* data, std::size_t size) {
+        std::size_t i = 0;
+        if (pending_size != 0) {
+            i = std::min(size, 8 - pending_size);
+            std::memcpy(reinterpret_cast<char*>(&pending) + pending_size, data, i);
+            pending_size += i;
+            if (pending_size != 8) {
+                return;
+            }
+            mix(pending);
+            pending = 0;
+            pending_size = 0;
+        }
+        for (; i + 8 <= size; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            mix(word);
+        }
+        if (i != size) {
+            std::memcpy(&pending, data + i, size - i);
+            pending_size = size - i;
+        }
+    }
+
+    std::uint64_t get() const {
+        // Trailing bytes are hashed as a word padded with zeros.
+        std::uint64_t result = pending_size == 0 ? state : step(state, pending);
+        result ^= length + pending_size;
+        result = (result ^ (result >> 33)) * 0xff51afd7ed558ccd;
+        result = (result ^ (result >> 33)) * 0xc4ceb9fe1a85ec53;
+        return result ^ (result >> 33);
+    }
+
+private:
+    static std::uint64_t step(std::uint64_t state, std::uint64_t word) {
+        return (((state << 23) | (state >> 41)) ^ word) * 0x9e3779b97f4a7c15;
+    }
+
+    void mix(std::uint64_t word) {
+        state = step(state, word);
+        length += 8;
+    }
+
+    std::uint64_t state = 0x243f6a8885a308d3;
+    std::uint64_t length = 0;
+    std::uint64_t pending = 0;
+    std::size_t pending_size = 0;
+};
+
+inline std::uint64_t hash_file(const std::string &path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    stable_hash hash;
+    std::vector<char> buffer(1 << 20);
+    std::size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) != 0) {
+        hash.add(buffer.data(), read);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed) {
+        throw std::runtime_error("Failed to read " + path);
+    }
+    return hash.get();
+}
+
+// File a table or a circuit of the session was read from, so that a reopened session can tell whether
+// the file has changed since. The path is empty if the file was not local.
+struct snapshot_source {
+    std::string path;
+    std::uint64_t size = 0;
+    // Nanoseconds since the epoch.
+    std::int64_t mtime = 0;
+    std::uint64_t hash = 0;
+};
+
+inline std::int64_t get_mtime(const struct stat &info) {
+    return std::int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+// Hashes the whole file, an empty path gives an empty source.
+inline snapshot_source describe_source_file(const std::string &path) {
+    snapshot_source source;
+    if (path.empty()) {
+        return source;
+    }
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    source.path = path;
+    source.size = info.st_size;
+    source.mtime = get_mtime(info);
+    source.hash = hash_file(path);
+    return source;
+}
+
+// The file is only hashed again if its size or modification time differ from the recorded ones.
+inline bool source_unchanged(const snapshot_source &source) {
+    if (source.path.empty()) {
+        return true;
+    }
+    struct stat info;
+    if (::stat(source.path.c_str(), &info) != 0) {
+        return false;
+    }
+    if (std::uint64_t(info.st_size) == source.size && get_mtime(info) == source.mtime) {
+        return true;
+    }
+    try {
+        return std::uint64_t(info.st_size) == source.size && hash_file(source.path) == source.hash;
+    } catch (const std::runtime_error &) {
+        return false;
+    }
+}
+
+// Read-only mapping of a whole file.
+class mapped_file {
+public:
+    explicit mapped_file(const std::string &path) : data(nullptr), size(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map " + path);
+        }
+        size = info.st_size;
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Failed to map " + path);
+        }
+        data = static_cast<const char*>(mapping);
+    }
+
+    ~mapped_file() {
+        ::munmap(const_cast<char*>(data), size);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* get_data() const {
+        return data;
+    }
+
+    std::size_t get_size() const {
+        return size;
+    }
+
+private:
+    const char* data;
+    std::size_t size;
+};
+
+enum class snapshot_section : std::uint32_t {
+    sources,
+    // Limbs of the non-zero blocks of the table, every block takes block_rows rows.
+    block_data,
+    // Index of the block in block_data for every block of every column, column-major, or empty_block.
+    block_map,
+    selector_words,
+    dag_nodes,
+    dag_constants,
+    dag_variables,
+    // Roots and node lists of the constraints, flattened over the gates and their constraints.
+    dag_roots,
+    dag_node_offsets,
+    dag_constraint_nodes,
+    // Selector index and amount of constraints of every gate.
+    gates,
+    copy_constraints,
+    gate_entries,
+    copy_entries,
+    check_failures,
+    amount
+};
+
+constexpr std::size_t snapshot_sections_amount = std::size_t(snapshot_section::amount);
+constexpr std::uint32_t snapshot_empty_block = ~std::uint32_t(0);
+constexpr char snapshot_magic[8] = {'E', 'X', 'C', 'S', 'N', 'A', 'P', '\0'};
+
+struct snapshot_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t modulus_bits;
+    std::uint32_t limbs_amount;
+    std::uint32_t has_check_result;
+    table_sizes table;
+    circuit_sizes circuit;
+    std::uint64_t check_evaluations;
+    std::uint64_t check_out_of_table_rows;
+    std::uint64_t section_offsets[snapshot_sections_amount];
+    std::uint64_t section_sizes[snapshot_sections_amount];
+};
+
+struct snapshot_source_record {
+    std::uint64_t size;
+    std::int64_t mtime;
+    std::uint64_t hash;
+    std::uint64_t path_size;
+};
+
+struct snapshot_variable {
+    std::uint64_t index;
+    std::int32_t rotation;
+    std::uint8_t type;
+    std::uint8_t relative;
+    std::uint16_t padding;
+};
+
+// Everything a session snapshot holds. The DAG and the index refer to the circuit and the store of the session.
+template<typename BlueprintFieldType>
+struct session_snapshot {
+    snapshot_source table_source;
+    snapshot_source circuit_source;
+    std::shared_ptr<table_store<BlueprintFieldType>> store;
+    circuit_container<BlueprintFieldType> circuit;
+    expression_dag<BlueprintFieldType> dag;
+    constraint_index<BlueprintFieldType> index;
+    bool has_check_result = false;
+    typename gate_evaluator<BlueprintFieldType>::check_result check_result;
+};
+
+// Writes the sections one after another and the header last. The file only appears under its name
+// once it is complete, a failed save leaves the previous snapshot intact.
+class snapshot_file_writer {
+public:
+    explicit snapshot_file_writer(const std::string &path_) :
+            path(path_), temp_path(path_ + ".tmp"), position(0), current(0), header() {
+        file = std::fopen(temp_path.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open " + temp_path + " for writing");
+        }
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 22);
+        write_raw(&header, sizeof(header));
+    }
+
+    ~snapshot_file_writer() {
+        if (file != nullptr) {
+            std::fclose(file);
+            std::remove(temp_path.c_str());
+        }
+    }
+
+    snapshot_file_writer(const snapshot_file_writer&) = delete;
+    snapshot_file_writer& operator=(const snapshot_file_writer&) = delete;
+
+    void begin_section(snapshot_section section) {
+        static const char zeroes[64] = {};
+        write_raw(zeroes, (64 - position % 64) % 64);
+        current = std::size_t(section);
+        header.section_offsets[current] = position;
+    }
+
+    void write(const void* data, std::size_t size) {
+        write_raw(data, size);
+        header.section_sizes[current] += size;
+    }
+
+    template<typename T>
+    void write_section(snapshot_section section, const T* data, std::size_t count) {
+        begin_section(section);
+        write(data, count * sizeof(T));
+    }
+
+    // Section offsets and sizes of the header are filled in here.
+    void finish(const snapshot_header &header_) {
+        snapshot_header result = header_;
+        std::copy(std::begin(header.section_offsets), std::end(header.section_offsets),
+                  std::begin(result.section_offsets));
+        std::copy(std::begin(header.section_sizes), std::end(header.section_sizes),
+                  std::begin(result.section_sizes));
+        bool failed = std::fseek(file, 0, SEEK_SET) != 0 ||
+                      std::fwrite(&result, sizeof(result), 1, file) != 1;
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+        if (failed || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Failed to write " + path);
+        }
+    }
+
+private:
+    void write_raw(const void* data, std::size_t size) {
+        if (size != 0 && std::fwrite(data, 1, size, file) != size) {
+            throw std::runtime_error("Failed to write " + temp_path);
+        }
+        position += size;
+    }
+
+    std::string path;
+    std::string temp_path;
+    std::FILE* file;
+    std::uint64_t position;
+    std::size_t current;
+    // Only collects the sections until finish.
+    snapshot_header header;
+};
+
+// Saves the session, check may be null if the table was not checked since it last changed.
+// Throws std::runtime_error on failures.
+template<typename BlueprintFieldType>
+void save_session_snapshot(const std::string &path, const table_store<BlueprintFieldType> &store,
+                           const circuit_container<BlueprintFieldType> &circuit,
+                           const expression_dag<BlueprintFieldType> &dag,
+                           const constraint_index<BlueprintFieldType> &index,
+                           const typename gate_evaluator<BlueprintFieldType>::check_result *check,
+                           const snapshot_source &table_source, const snapshot_source &circuit_source) {
+    using traits = field_traits<BlueprintFieldType>;
+    using store_type = table_store<BlueprintFieldType>;
+    constexpr std::size_t limbs_amount = traits::limbs_amount;
+    constexpr std::size_t block_rows = store_type::block_rows;
+
+    snapshot_file_writer writer(path);
+
+    writer.begin_section(snapshot_section::sources);
+    for (const snapshot_source *source : {&table_source, &circuit_source}) {
+        snapshot_source_record record = {source->size, source->mtime, source->hash, source->path.size()};
+        writer.write(&record, sizeof(record));
+    }
+    writer.write(table_source.path.data(), table_source.path.size());
+    writer.write(circuit_source.path.data(), circuit_source.path.size());
+
+    // Paged stores are read one row block at a time, so blocks go in row block order. Blocks of zeroes are skipped.
+    const std::size_t columns_amount = store.get_columns_amount();
+    const std::size_t row_blocks = store.get_row_blocks_amount();
+    std::vector<typename store_type::column_span> columns;
+    for (std::size_t column = 0; column < columns_amount; column++) {
+        columns.push_back(store.get_column_span(column));
+    }
+    std::vector<std::uint32_t> block_map(columns_amount * row_blocks, snapshot_empty_block);
+    std::vector<std::uint64_t> limbs(block_rows * limbs_amount);
+    std::uint32_t blocks_written = 0;
+    writer.begin_section(snapshot_section::block_data);
+    for (std::size_t block = 0; block < row_blocks; block++) {
+        const std::size_t first_row = block * block_rows;
+        const std::size_t rows = std::min(block_rows, store.get_rows_amount() - first_row);
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            const auto &span = columns[column];
+            if (span.blocks != nullptr && span.blocks[block].empty()) {
+                continue;
+            }
+            std::fill(limbs.begin(), limbs.end(), 0);
+            bool non_zero = false;
+            for (std::size_t i = 0; i < rows; i++) {
+                auto cell = span[first_row + i];
+                if (!traits::is_zero(cell)) {
+                    non_zero = true;
+                    traits::to_limbs(cell, limbs.data() + i * limbs_amount);
+                }
+            }
+            if (non_zero) {
+                block_map[column * row_blocks + block] = blocks_written++;
+                writer.write(limbs.data(), limbs.size() * sizeof(std::uint64_t));
+            }
+        }
+    }
+    writer.write_section(snapshot_section::block_map, block_map.data(), block_map.size());
+
+    writer.begin_section(snapshot_section::selector_words);
+    for (std::size_t selector = 0; selector < store.get_sizes().selectors_size; selector++) {
+        const auto &words = store.get_selector_bitmap(selector).get_words();
+        writer.write(words.data(), words.size() * sizeof(std::uint64_t));
+    }
+
+    const auto &nodes = dag.get_nodes();
+    writer.write_section(snapshot_section::dag_nodes, nodes.data(), nodes.size());
+    writer.begin_section(snapshot_section::dag_constants);
+    for (const auto &constant : dag.get_constants()) {
+        traits::to_limbs(traits::from_value(constant), limbs.data());
+        writer.write(limbs.data(), limbs_amount * sizeof(std::uint64_t));
+    }
+    auto to_record = [](const auto &variable) {
+        return snapshot_variable{variable.index, variable.rotation, std::uint8_t(variable.type),
+                                 std::uint8_t(variable.relative), 0};
+    };
+    writer.begin_section(snapshot_section::dag_variables);
+    for (const auto &variable : dag.get_variables()) {
+        snapshot_variable record = to_record(variable);
+        writer.write(&record, sizeof(record));
+    }
+
+    std::vector<std::uint32_t> gates, roots, constraint_nodes;
+    std::vector<std::uint64_t> node_offsets = {0};
+    for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+        gates.push_back(std::uint32_t(circuit.gates[i].selector_index));
+        gates.push_back(std::uint32_t(circuit.gates[i].constraints.size()));
+        for (std::size_t j = 0; j < circuit.gates[i].constraints.size(); j++) {
+            roots.push_back(dag.get_root(i, j));
+            const auto &constraint_node_list = dag.get_constraint_nodes(i, j);
+            constraint_nodes.insert(constraint_nodes.end(), constraint_node_list.begin(), constraint_node_list.end());
+            node_offsets.push_back(constraint_nodes.size());
+        }
+    }
+    writer.write_section(snapshot_section::dag_roots, roots.data(), roots.size());
+    writer.write_section(snapshot_section::dag_node_offsets, node_offsets.data(), node_offsets.size());
+    writer.write_section(snapshot_section::dag_constraint_nodes, constraint_nodes.data(), constraint_nodes.size());
+    writer.write_section(snapshot_section::gates, gates.data(), gates.size());
+    writer.begin_section(snapshot_section::copy_constraints);
+    for (const auto &constraint : circuit.copy_constraints) {
+        snapshot_variable records[2] = {to_record(constraint.first), to_record(constraint.second)};
+        writer.write(records, sizeof(records));
+    }
+
+    const auto &gate_entries = index.get_gate_entries();
+    const auto &copy_entries = index.get_copy_entries();
+    writer.write_section(snapshot_section::gate_entries, gate_entries.data(), gate_entries.size());
+    writer.write_section(snapshot_section::copy_entries, copy_entries.data(), copy_entries.size());
+    if (check != nullptr) {
+        writer.write_section(snapshot_section::check_failures, check->failures.data(), check->failures.size());
+    }
+
+    snapshot_header header = {};
+    std::copy(std::begin(snapshot_magic), std::end(snapshot_magic), header.magic);
+    header.version = snapshot_version;
+    header.modulus_bits = BlueprintFieldType::modulus_bits;
+    header.limbs_amount = limbs_amount;
+    header.has_check_result = check != nullptr;
+    header.table = store.get_sizes();
+    header.circuit = circuit.sizes;
+    header.check_evaluations = check != nullptr ? check->evaluations : 0;
+    header.check_out_of_table_rows = check != nullptr ? check->out_of_table_rows : 0;
+    writer.finish(header);
+}
+
+// Typed views of the sections of a mapped snapshot, every section is checked to fit into the file.
+class snapshot_sections {
+public:
+    snapshot_sections(const mapped_file &file_, const snapshot_header &header_) : file(file_), header(header_) {}
+
+    template<typename T>
+    const T* get(snapshot_section section, std::size_t &count) const {
+        const std::uint64_t offset = header.section_offsets[std::size_t(section)];
+        const std::uint64_t size = header.section_sizes[std::size_t(section)];
+        if (offset > file.get_size() || size > file.get_size() - offset || size % sizeof(T) != 0 ||
+            offset % alignof(T) != 0) {
+            throw std::runtime_error("The snapshot is corrupted");
+        }
+        count = size / sizeof(T);
+        return reinterpret_cast<const T*>(file.get_data() + offset);
+    }
+
+    // Also checks the amount of elements.
+    template<typename T>
+    const T* get(snapshot_section section, std::size_t expected_count, const char* what) const {
+        std::size_t count;
+        const T* result = get<T>(section, count);
+        if (count != expected_count) {
+            throw std::runtime_error(std::string("The snapshot is corrupted: wrong size of ") + what);
+        }
+        return result;
+    }
+
+private:
+    const mapped_file &file;
+    const snapshot_header &header;
+};
+
+// Throws std::runtime_error if the file is not a snapshot of this version and field, or is corrupted.
+template<typename BlueprintFieldType>
+void load_session_snapshot(const std::string &path, session_snapshot<BlueprintFieldType> &session) {
+    using traits = field_traits<BlueprintFieldType>;
+    using store_type = table_store<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+    using value_type = typename BlueprintFieldType::value_type;
+    using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
+    using dag_type = expression_dag<BlueprintFieldType>;
+    using node_kind = typename dag_type::node_kind;
+    using failure = typename gate_evaluator<BlueprintFieldType>::failure;
+    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
+    constexpr std::size_t limbs_amount = traits::limbs_amount;
+    constexpr std::size_t block_rows = store_type::block_rows;
+
+    mapped_file file(path);
+    snapshot_header header;
+    if (file.get_size() < sizeof(header)) {
+        throw std::runtime_error(path + " is not a session snapshot");
+    }
+    std::memcpy(&header, file.get_data(), sizeof(header));
+    if (!std::equal(std::begin(snapshot_magic), std::end(snapshot_magic), header.magic)) {
+        throw std::runtime_error(path + " is not a session snapshot");
+    }
+    if (header.version != snapshot_version) {
+        throw std::runtime_error("The snapshot has version " + std::to_string(header.version) + ", only version " +
+                                 std::to_string(snapshot_version) + " can be read");
+    }
+    if (header.modulus_bits != BlueprintFieldType::modulus_bits || header.limbs_amount != limbs_amount) {
+        throw std::runtime_error("The snapshot was saved for a field of " + std::to_string(header.modulus_bits) +
+                                 " bits");
+    }
+    snapshot_sections sections(file, header);
+
+    std::size_t sources_size;
+    const char* sources = sections.get<char>(snapshot_section::sources, sources_size);
+    snapshot_source_record records[2];
+    if (sources_size < sizeof(records)) {
+        throw std::runtime_error("The snapshot is corrupted: wrong size of sources");
+    }
+    std::memcpy(records, sources, sizeof(records));
+    std::size_t path_offset = sizeof(records);
+    snapshot_source* session_sources[2] = {&session.table_source, &session.circuit_source};
+    for (std::size_t i = 0; i < 2; i++) {
+        if (records[i].path_size > sources_size - path_offset) {
+            throw std::runtime_error("The snapshot is corrupted: wrong size of sources");
+        }
+        session_sources[i]->path.assign(sources + path_offset, records[i].path_size);
+        session_sources[i]->size = records[i].size;
+        session_sources[i]->mtime = records[i].mtime;
+        session_sources[i]->hash = records[i].hash;
+        path_offset += records[i].path_size;
+    }
+
+    // Table values. Columns are filled in parallel, which is safe as they share no blocks.
+    const table_sizes &sizes = header.table;
+    auto store = std::make_shared<store_type>(sizes);
+    const std::size_t columns_amount = store->get_columns_amount();
+    const std::size_t row_blocks = store->get_row_blocks_amount();
+    const std::uint32_t* block_map =
+        sections.get<std::uint32_t>(snapshot_section::block_map, columns_amount * row_blocks, "the block map");
+    std::size_t block_data_size;
+    const std::uint64_t* block_data = sections.get<std::uint64_t>(snapshot_section::block_data, block_data_size);
+    const std::size_t blocks_amount = block_data_size / (block_rows * limbs_amount);
+    std::atomic<bool> bad_block(false);
+    const std::size_t threads_amount =
+        std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), columns_amount));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_amount; t++) {
+        threads.emplace_back([&, t]() {
+            std::vector<cell_type> cells(block_rows);
+            for (std::size_t column = t; column < columns_amount; column += threads_amount) {
+                for (std::size_t block = 0; block < row_blocks; block++) {
+                    const std::uint32_t slot = block_map[column * row_blocks + block];
+                    if (slot == snapshot_empty_block) {
+                        continue;
+                    }
+                    if (slot >= blocks_amount) {
+                        bad_block = true;
+                        continue;
+                    }
+                    const std::uint64_t* limbs = block_data + std::size_t(slot) * block_rows * limbs_amount;
+                    if constexpr (traits::is_small) {
+                        store->fill_column_block(column, block, limbs);
+                    } else {
+                        for (std::size_t i = 0; i < block_rows; i++) {
+                            cells[i] = traits::from_limbs(limbs + i * limbs_amount);
+                        }
+                        store->fill_column_block(column, block, cells.data());
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (bad_block) {
+        throw std::runtime_error("The snapshot is corrupted: wrong block in the block map");
+    }
+    const std::size_t bitmap_words = (std::size_t(sizes.max_size) + 63) / 64;
+    const std::uint64_t* selector_words = sections.get<std::uint64_t>(
+        snapshot_section::selector_words, bitmap_words * sizes.selectors_size, "selector bitmaps");
+    for (std::size_t selector = 0; selector < sizes.selectors_size; selector++) {
+        row_bitset bitmap(sizes.max_size);
+        std::copy(selector_words + selector * bitmap_words, selector_words + (selector + 1) * bitmap_words,
+                  bitmap.get_words().begin());
+        store->set_selector_bitmap(selector, std::move(bitmap));
+    }
+
+    // The DAG, checked so that evaluating it can not go out of bounds.
+    std::size_t nodes_size, constants_size, variables_size;
+    const auto* nodes = sections.get<typename dag_type::node>(snapshot_section::dag_nodes, nodes_size);
+    const std::uint64_t* constant_limbs = sections.get<std::uint64_t>(snapshot_section::dag_constants,
+                                                                      constants_size);
+    const snapshot_variable* variable_records =
+        sections.get<snapshot_variable>(snapshot_section::dag_variables, variables_size);
+    constants_size /= limbs_amount;
+    auto to_variable = [&sizes](const snapshot_variable &record) {
+        const std::size_t amounts[] = {sizes.witnesses_size, sizes.public_inputs_size, sizes.constants_size,
+                                       sizes.selectors_size};
+        if (record.type > std::uint8_t(var::column_type::selector) || record.index >= amounts[record.type]) {
+            throw std::runtime_error("The snapshot is corrupted: wrong variable");
+        }
+        return var(record.index, record.rotation, record.relative != 0, typename var::column_type(record.type));
+    };
+    std::vector<value_type> constants;
+    for (std::size_t i = 0; i < constants_size; i++) {
+        constants.push_back(traits::to_value(traits::from_limbs(constant_limbs + i * limbs_amount)));
+    }
+    std::vector<var> variables;
+    for (std::size_t i = 0; i < variables_size; i++) {
+        variables.push_back(to_variable(variable_records[i]));
+    }
+    for (std::size_t i = 0; i < nodes_size; i++) {
+        const auto &current = nodes[i];
+        bool valid;
+        switch (current.kind) {
+            case node_kind::constant:
+                valid = current.left < constants_size;
+                break;
+            case node_kind::variable:
+                valid = current.left < variables_size;
+                break;
+            case node_kind::pow:
+                valid = current.left < i;
+                break;
+            case node_kind::add:
+            case node_kind::sub:
+            case node_kind::mul:
+                valid = current.left < i && current.right < i;
+                break;
+            default:
+                valid = false;
+        }
+        if (!valid) {
+            throw std::runtime_error("The snapshot is corrupted: wrong DAG node " + std::to_string(i));
+        }
+    }
+
+    // Constraints are rebuilt from the DAG, they evaluate the same as the parsed ones, but products with
+    // coefficients become separate multiplications.
+    std::size_t gates_size;
+    const std::uint32_t* gate_records = sections.get<std::uint32_t>(snapshot_section::gates, gates_size);
+    gates_size /= 2;
+    if (gates_size != header.circuit.gates_size) {
+        throw std::runtime_error("The snapshot is corrupted: wrong amount of gates");
+    }
+    std::size_t constraints_amount = 0;
+    for (std::size_t i = 0; i < gates_size; i++) {
+        if (gate_records[2 * i] >= sizes.selectors_size) {
+            throw std::runtime_error("The snapshot is corrupted: wrong selector of gate " + std::to_string(i));
+        }
+        constraints_amount += gate_records[2 * i + 1];
+    }
+    const std::uint32_t* roots =
+        sections.get<std::uint32_t>(snapshot_section::dag_roots, constraints_amount, "constraint roots");
+    const std::uint64_t* node_offsets = sections.get<std::uint64_t>(
+        snapshot_section::dag_node_offsets, constraints_amount + 1, "constraint node offsets");
+    std::size_t constraint_nodes_size;
+    const std::uint32_t* constraint_nodes =
+        sections.get<std::uint32_t>(snapshot_section::dag_constraint_nodes, constraint_nodes_size);
+    for (std::size_t k = 0; k < constraints_amount; k++) {
+        if (roots[k] >= nodes_size || node_offsets[k] > node_offsets[k + 1] ||
+            node_offsets[k + 1] > constraint_nodes_size) {
+            throw std::runtime_error("The snapshot is corrupted: wrong constraint " + std::to_string(k));
+        }
+    }
+    for (std::size_t i = 0; i < constraint_nodes_size; i++) {
+        if (constraint_nodes[i] >= nodes_size) {
+            throw std::runtime_error("The snapshot is corrupted: wrong constraint node");
+        }
+    }
+    std::function<plonk_constraint_type(std::uint32_t)> rebuild = [&](std::uint32_t node_idx) {
+        const auto &current = nodes[node_idx];
+        switch (current.kind) {
+            case node_kind::constant:
+                return plonk_constraint_type(nil::crypto3::math::term<var>(constants[current.left]));
+            case node_kind::variable:
+                return plonk_constraint_type(nil::crypto3::math::term<var>(variables[current.left]));
+            case node_kind::add:
+                return plonk_constraint_type(rebuild(current.left) + rebuild(current.right));
+            case node_kind::sub:
+                return plonk_constraint_type(rebuild(current.left) - rebuild(current.right));
+            case node_kind::mul:
+                return plonk_constraint_type(rebuild(current.left) * rebuild(current.right));
+            default:
+                return plonk_constraint_type(rebuild(current.left).pow(current.right));
+        }
+    };
+    circuit_container<BlueprintFieldType> &circuit = session.circuit;
+    circuit.sizes = header.circuit;
+    circuit.gates.reserve(gates_size);
+    for (std::size_t i = 0, k = 0; i < gates_size; i++) {
+        std::vector<plonk_constraint_type> constraints;
+        for (std::uint32_t j = 0; j < gate_records[2 * i + 1]; j++, k++) {
+            constraints.push_back(rebuild(roots[k]));
+        }
+        circuit.gates.emplace_back(gate_records[2 * i], std::vector<plonk_constraint_type>());
+        circuit.gates.back().constraints.swap(constraints);
+    }
+    const snapshot_variable* copy_records = sections.get<snapshot_variable>(
+        snapshot_section::copy_constraints, 2 * std::size_t(header.circuit.copy_constraints_size),
+        "copy constraints");
+    for (std::size_t i = 0; i < header.circuit.copy_constraints_size; i++) {
+        circuit.copy_constraints.push_back({to_variable(copy_records[2 * i]), to_variable(copy_records[2 * i + 1])});
+    }
+    session.dag.assign(circuit, nodes, nodes_size, constants, variables, roots, node_offsets, constraint_nodes);
+
+    // The index is taken as it is, only the constraints it refers to are checked.
+    std::size_t gate_entries_size, copy_entries_size;
+    const auto* gate_entries = sections.get<gate_constraint_entry>(snapshot_section::gate_entries,
+                                                                   gate_entries_size);
+    const auto* copy_entries = sections.get<copy_constraint_entry>(snapshot_section::copy_entries,
+                                                                   copy_entries_size);
+    for (std::size_t i = 0; i < gate_entries_size; i++) {
+        const auto &entry = gate_entries[i];
+        if (entry.gate >= gates_size || entry.constraint_num >= gate_records[2 * entry.gate + 1] ||
+            entry.row >= sizes.max_size) {
+            throw std::runtime_error("The snapshot is corrupted: wrong constraint index entry");
+        }
+    }
+    for (std::size_t i = 0; i < copy_entries_size; i++) {
+        if (copy_entries[i].constraint_num >= header.circuit.copy_constraints_size) {
+            throw std::runtime_error("The snapshot is corrupted: wrong constraint index entry");
+        }
+    }
+    session.index.assign(columns_amount,
+                         std::vector<gate_constraint_entry>(gate_entries, gate_entries + gate_entries_size),
+                         std::vector<copy_constraint_entry>(copy_entries, copy_entries + copy_entries_size));
+
+    session.has_check_result = header.has_check_result != 0;
+    if (session.has_check_result) {
+        std::size_t failures_size;
+        const failure* failures = sections.get<failure>(snapshot_section::check_failures, failures_size);
+        for (std::size_t i = 0; i < failures_size; i++) {
+            if (failures[i].gate >= gates_size ||
+                failures[i].constraint_num >= gate_records[2 * failures[i].gate + 1]) {
+                throw std::runtime_error("The snapshot is corrupted: wrong check failure");
+            }
+        }
+        session.check_result.failures.assign(failures, failures + failures_size);
+        session.check_result.evaluations = header.check_evaluations;
+        session.check_result.out_of_table_rows = header.check_out_of_table_rows;
+    }
+    session.store = store;
+}
@@ -0,0 +1,520 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/arithmetization/plonk/variable.hpp>
+
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "row_bitset.hpp"
+
+template<typename T, std::size_t Alignment>
+struct aligned_allocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        std::size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void* ptr = std::aligned_alloc(Alignment, bytes);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t) {
+        std::free(ptr);
+    }
+
+    template<typename U>
+    bool operator==(const aligned_allocator<U, Alignment>&) const {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const aligned_allocator<U, Alignment>&) const {
+        return false;
+    }
+};
+
+// Source of the values of a paged table_store, a page is table_store::block_rows rows of all the columns.
+// Values are exchanged row-major: values[i * columns_amount + column] is the cell of the i-th row of the page.
+template<typename BlueprintFieldType>
+class table_page_source {
+public:
+    using cell_type = typename field_traits<BlueprintFieldType>::cell_type;
+
+    virtual ~table_page_source() = default;
+
+    virtual void read_page(std::size_t page, std::vector<cell_type> &values) = 0;
+    virtual void write_page(std::size_t page, const std::vector<cell_type> &values) = 0;
+};
+
+// Part of a table loaded into a store, see table_window.hpp. Rows of the store are the rows
+// [first_row, first_row + rows_amount) of the table, columns which are not loaded read as zeroes.
+struct table_window {
+    std::size_t first_row = 0;
+    // Up to the end of the table if 0.
+    std::size_t rows_amount = 0;
+    // Indexed as in table_store, all the columns are loaded if it is empty.
+    std::vector<bool> columns;
+
+    // The store holds the whole table.
+    bool is_whole() const {
+        return first_row == 0 && rows_amount == 0 && columns.empty();
+    }
+
+    bool is_column_loaded(std::size_t column) const {
+        return columns.empty() || columns[column];
+    }
+};
+
+// Values of the assignment table, stored column-major in cache line aligned blocks of block_rows rows.
+// Gate evaluation reads a handful of columns at neighbouring rows, which with this layout are next to each other.
+// A block is only allocated once a non-zero value is written into it, so padding rows and unused columns
+// take no memory and read as zeroes.
+// Columns are indexed without the "Row" column of the view: witnesses, then public inputs, constants and selectors.
+// For every selector the store also keeps a bitset of rows at which it is enabled, it is kept up to date on writes.
+// Cells are kept as field_traits<BlueprintFieldType>::cell_type, which is a plain std::uint64_t for small fields.
+// A store can also be paged, see set_page_source, then only a bounded amount of row blocks is kept in memory.
+template<typename BlueprintFieldType>
+class table_store {
+public:
+    using value_type = typename BlueprintFieldType::value_type;
+    using integral_type = typename BlueprintFieldType::integral_type;
+    using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t block_rows = 1024;
+
+    using block_type = std::vector<cell_type, aligned_allocator<cell_type, alignment>>;
+
+    struct column_span {
+        // Paged stores have no blocks to look at directly, cells are read through the store.
+        const table_store* store;
+        const block_type* blocks;
+        std::size_t column;
+        std::size_t size;
+
+        cell_type operator[](std::size_t row) const {
+            if (blocks == nullptr) {
+                return store->get_cell(column, row);
+            }
+            const block_type &block = blocks[row / block_rows];
+            return block.empty() ? zero() : block[row % block_rows];
+        }
+    };
+
+    table_store() : sizes(), columns_amount(0), column_blocks(0), version(0), max_resident_pages(0) {}
+
+    table_store(const table_sizes &sizes_) : version(0), max_resident_pages(0) {
+        resize(sizes_);
+    }
+
+    table_store(const table_store&) = delete;
+    table_store& operator=(const table_store&) = delete;
+
+    // Drops all the values, the table is filled with zeroes.
+    void resize(const table_sizes &sizes_) {
+        sizes = sizes_;
+        columns_amount = sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size +
+                         sizes.selectors_size;
+        column_blocks = (std::size_t(sizes.max_size) + block_rows - 1) / block_rows;
+        blocks.clear();
+        blocks.resize(columns_amount * column_blocks);
+        version++;
+        selector_bitmaps.assign(sizes.selectors_size, row_bitset(sizes.max_size));
+        source.reset();
+        lru.clear();
+        page_states.clear();
+        lru_positions.clear();
+        window = table_window();
+    }
+
+    // Marks the store as holding only a part of a larger table, the sizes of the store are those of the part.
+    void set_window(const table_window &window_) {
+        window = window_;
+    }
+
+    const table_window& get_window() const {
+        return window;
+    }
+
+    // Row of the store holding a row of the whole table, negative or past the end if it is not loaded.
+    // Copy constraints refer to rows of the whole table.
+    std::int64_t get_store_row(std::int64_t table_row) const {
+        return table_row - std::int64_t(window.first_row);
+    }
+
+    // Makes the store paged: row blocks are read from the source on first access and at most
+    // max_resident_pages_ of them are kept in memory, the least recently used ones are dropped first.
+    // Modified row blocks are written back to the source when they are dropped, or on flush.
+    // Selector bitmaps are not read from the source, they have to be set with set_selector_bitmap.
+    // Reading a paged store changes it, so it must not be accessed from several threads at once.
+    void set_page_source(const std::shared_ptr<table_page_source<BlueprintFieldType>> &source_,
+                         std::size_t max_resident_pages_) {
+        source = source_;
+        max_resident_pages = std::max<std::size_t>(1, max_resident_pages_);
+        page_states.assign(column_blocks, page_state::absent);
+        lru_positions.assign(column_blocks, lru.end());
+    }
+
+    bool is_paged() const {
+        return source != nullptr;
+    }
+
+    // Memory taken by the cells of a single row block.
+    std::size_t get_page_memory_size() const {
+        return columns_amount * block_rows * sizeof(cell_type);
+    }
+
+    std::size_t get_resident_pages_amount() const {
+        return lru.size();
+    }
+
+    // Writes the modified row blocks back to the source, they stay in memory.
+    void flush() {
+        if (!source) {
+            return;
+        }
+        for (std::size_t page : lru) {
+            if (page_states[page] == page_state::dirty) {
+                write_page(page);
+                page_states[page] = page_state::resident;
+            }
+        }
+    }
+
+    // Reads the row block in if it is not in memory yet, lets callers read ahead of the accesses.
+    void prefetch(std::size_t page) const {
+        if (source && page < column_blocks && page_states[page] == page_state::absent) {
+            touch_page(page);
+        }
+    }
+
+    // Sets every cell of a row block from row-major values, in the layout of table_page_source.
+    // Meant for filling a new store which is not paged: the version is left as it is, and different row blocks
+    // can be filled from several threads at once, as they share no memory, selector bitmap words included.
+    void fill_row_block(std::size_t block, const std::vector<cell_type> &values) {
+        fill_blocks(block, values);
+        const std::size_t selectors_start = columns_amount - sizes.selectors_size;
+        const std::size_t first_row = block * block_rows;
+        for (std::size_t i = 0; i < get_page_rows(block); i++) {
+            for (std::size_t selector = 0; selector < sizes.selectors_size; selector++) {
+                selector_bitmaps[selector].set(
+                    first_row + i, !traits::is_zero(values[i * columns_amount + selectors_start + selector]));
+            }
+        }
+    }
+
+    // Sets a block of a column from the cells of its rows, in the same manner as fill_row_block,
+    // except that selector bitmaps are left to set_selector_bitmap. Blocks which are not filled read as zeroes.
+    void fill_column_block(std::size_t column, std::size_t block, const cell_type* values) {
+        blocks[column * column_blocks + block].assign(values, values + get_page_rows(block));
+    }
+
+    // Hands over a row block read in elsewhere, e.g. on another thread, in the layout of table_page_source.
+    // Nothing is done if the row block is already in memory, as it may have been modified since.
+    // Returns whether the row block was taken.
+    bool install_page(std::size_t page, const std::vector<cell_type> &values) {
+        if (!source || page >= column_blocks || page_states[page] != page_state::absent ||
+            values.size() != get_page_rows(page) * columns_amount) {
+            return false;
+        }
+        while (lru.size() >= max_resident_pages) {
+            evict_page(lru.back());
+        }
+        load_page(page, values);
+        return true;
+    }
+
+    void set_selector_bitmap(std::size_t selector, row_bitset bitmap) {
+        selector_bitmaps[selector] = std::move(bitmap);
+    }
+
+    const table_sizes& get_sizes() const {
+        return sizes;
+    }
+
+    std::size_t get_rows_amount() const {
+        return sizes.max_size;
+    }
+
+    std::size_t get_columns_amount() const {
+        return columns_amount;
+    }
+
+    static std::size_t get_column_index(const var &variable, const table_sizes &sizes) {
+        switch (variable.type) {
+            case var::column_type::witness:
+                return variable.index;
+            case var::column_type::public_input:
+                return variable.index + sizes.witnesses_size;
+            case var::column_type::constant:
+                return variable.index + sizes.witnesses_size + sizes.public_inputs_size;
+            case var::column_type::selector:
+                return variable.index + sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size;
+            default:
+                throw std::runtime_error("Attempted to get column index of uninitialized variable");
+        }
+    }
+
+    std::size_t get_column_index(const var &variable) const {
+        return get_column_index(variable, sizes);
+    }
+
+    std::size_t get_selector_column_index(std::size_t selector) const {
+        return sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + selector;
+    }
+
+    cell_type get_cell(std::size_t column, std::size_t row) const {
+        if (source) {
+            touch_page(row / block_rows);
+        }
+        const block_type &block = blocks[column * column_blocks + row / block_rows];
+        return block.empty() ? zero() : block[row % block_rows];
+    }
+
+    value_type get(std::size_t column, std::size_t row) const {
+        return traits::to_value(get_cell(column, row));
+    }
+
+    bool is_zero(std::size_t column, std::size_t row) const {
+        if (source) {
+            touch_page(row / block_rows);
+        }
+        const block_type &block = blocks[column * column_blocks + row / block_rows];
+        return block.empty() || traits::is_zero(block[row % block_rows]);
+    }
+
+    void set(std::size_t column, std::size_t row, const value_type &value) {
+        set_cell(column, row, traits::from_value(value));
+    }
+
+    void set_cell(std::size_t column, std::size_t row, const cell_type &value) {
+        if (source) {
+            touch_page(row / block_rows);
+            page_states[row / block_rows] = page_state::dirty;
+        }
+        block_type &block = blocks[column * column_blocks + row / block_rows];
+        if (block.empty()) {
+            if (traits::is_zero(value)) {
+                return;
+            }
+            // The last block of a column only covers the remaining rows.
+            block.assign(std::min(block_rows, std::size_t(sizes.max_size) - row / block_rows * block_rows), zero());
+        }
+        block[row % block_rows] = value;
+        version++;
+        update_selector_bitmap(column, row, value);
+    }
+
+    // Row values are in the order they appear in the table file.
+    void set_row(std::size_t row, const std::vector<typename traits::parsed_type> &row_values) {
+        if (source) {
+            touch_page(row / block_rows);
+        }
+        for (std::size_t i = 0; i < row_values.size() && i < columns_amount; i++) {
+            if (row_values[i] == 0 && blocks[i * column_blocks + row / block_rows].empty()) {
+                continue;
+            }
+            set_cell(i, row, traits::from_parsed(row_values[i]));
+        }
+    }
+
+    std::size_t get_allocated_blocks_amount() const {
+        return std::count_if(blocks.begin(), blocks.end(), [](const block_type &block) { return !block.empty(); });
+    }
+
+    std::size_t get_blocks_amount() const {
+        return blocks.size();
+    }
+
+    std::size_t get_memory_size() const {
+        std::size_t result = blocks.size() * sizeof(block_type);
+        for (const block_type &block : blocks) {
+            result += block.size() * sizeof(cell_type);
+        }
+        return result;
+    }
+
+    const row_bitset& get_selector_bitmap(std::size_t selector) const {
+        return selector_bitmaps[selector];
+    }
+
+    bool selector_enabled(std::size_t selector, std::size_t row) const {
+        return selector_bitmaps[selector].test(row);
+    }
+
+    std::size_t get_selector_rows_amount(std::size_t selector) const {
+        return selector_bitmaps[selector].count();
+    }
+
+    std::size_t get_row_blocks_amount() const {
+        return column_blocks;
+    }
+
+    // Cells of a column in the rows [block * block_rows, (block + 1) * block_rows), empty if they are all zeroes.
+    // The reference is only valid until the next access to a paged store.
+    const block_type& get_column_block(std::size_t column, std::size_t block) const {
+        if (source) {
+            touch_page(block);
+        }
+        return blocks[column * column_blocks + block];
+    }
+
+    // Changes on every write, lets caches built over the values notice that they are stale.
+    std::uint64_t get_version() const {
+        return version;
+    }
+
+    column_span get_column_span(std::size_t column) const {
+        return column_span{this, source ? nullptr : blocks.data() + column * column_blocks, column, sizes.max_size};
+    }
+
+    static const cell_type& zero() {
+        static const cell_type zero_value = traits::from_value(value_type::zero());
+        return zero_value;
+    }
+
+private:
+    enum class page_state : std::uint8_t {
+        absent,
+        resident,
+        dirty,
+    };
+
+    // Makes the row block resident and the most recently used one.
+    void touch_page(std::size_t page) const {
+        if (page_states[page] != page_state::absent) {
+            if (lru_positions[page] != lru.begin()) {
+                lru.splice(lru.begin(), lru, lru_positions[page]);
+            }
+            return;
+        }
+        while (lru.size() >= max_resident_pages) {
+            evict_page(lru.back());
+        }
+        page_buffer.resize(get_page_rows(page) * columns_amount);
+        source->read_page(page, page_buffer);
+        load_page(page, page_buffer);
+    }
+
+    // Fills the blocks of an absent row block from row-major values and makes it the most recently used one.
+    void load_page(std::size_t page, const std::vector<cell_type> &values) const {
+        fill_blocks(page, values);
+        page_states[page] = page_state::resident;
+        lru.push_front(page);
+        lru_positions[page] = lru.begin();
+    }
+
+    // Replaces the blocks of a row block with row-major values, blocks of zeros are not allocated.
+    void fill_blocks(std::size_t page, const std::vector<cell_type> &values) const {
+        const std::size_t page_rows = get_page_rows(page);
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            block_type &block = blocks[column * column_blocks + page];
+            block_type().swap(block);
+            for (std::size_t i = 0; i < page_rows; i++) {
+                const cell_type &value = values[i * columns_amount + column];
+                if (traits::is_zero(value)) {
+                    continue;
+                }
+                if (block.empty()) {
+                    block.assign(page_rows, zero());
+                }
+                block[i] = value;
+            }
+        }
+    }
+
+    void evict_page(std::size_t page) const {
+        if (page_states[page] == page_state::dirty) {
+            write_page(page);
+        }
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            block_type().swap(blocks[column * column_blocks + page]);
+        }
+        page_states[page] = page_state::absent;
+        lru.erase(lru_positions[page]);
+        lru_positions[page] = lru.end();
+    }
+
+    void write_page(std::size_t page) const {
+        const std::size_t page_rows = get_page_rows(page);
+        page_buffer.assign(page_rows * columns_amount, zero());
+        for (std::size_t column = 0; column < columns_amount; column++) {
+            const block_type &block = blocks[column * column_blocks + page];
+            for (std::size_t i = 0; i < block.size(); i++) {
+                page_buffer[i * columns_amount + column] = block[i];
+            }
+        }
+        source->write_page(page, page_buffer);
+    }
+
+    std::size_t get_page_rows(std::size_t page) const {
+        return std::min(block_rows, std::size_t(sizes.max_size) - page * block_rows);
+    }
+
+    void update_selector_bitmap(std::size_t column, std::size_t row, const cell_type &value) {
+        const std::size_t selectors_start = columns_amount - sizes.selectors_size;
+        if (column >= selectors_start) {
+            selector_bitmaps[column - selectors_start].set(row, !traits::is_zero(value));
+        }
+    }
+
+    table_sizes sizes;
+    std::size_t columns_amount;
+    std::size_t column_blocks;
+    // Blocks of a paged store are filled in and dropped on reads as well.
+    mutable std::vector<block_type> blocks;
+    std::uint64_t version;
+    std::vector<row_bitset> selector_bitmaps;
+    std::shared_ptr<table_page_source<BlueprintFieldType>> source;
+    std::size_t max_resident_pages;
+    table_window window;
+    // Resident row blocks, the most recently used first.
+    mutable std::list<std::size_t> lru;
+    mutable std::vector<std::list<std::size_t>::iterator> lru_positions;
+    mutable std::vector<page_state> page_states;
+    mutable std::vector<cell_type> page_buffer;
+};
@@ -24,24 +24,34 @@
 
 //#define BOOST_SPIRIT_DEBUG
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <array>
 #include <filesystem>
 
 #include <boost/spirit/include/qi.hpp>
 #include <boost/phoenix/phoenix.hpp>
 #include <boost/variant.hpp>
 
+#include <giomm/filemonitor.h>
+#include <giomm/listmodel.h>
 #include <giomm/liststore.h>
 
+#include <glibmm/dispatcher.h>
+#include <glibmm/error.h>
+#include <glibmm/main.h>
 #include <glibmm/value.h>
 
 #include <pangomm/layout.h>
@@ -54,6 +64,7 @@
 #include <gtkmm/entry.h>
 #include <gtkmm/button.h>
 #include <gtkmm/scrolledwindow.h>
+#include <gtkmm/adjustment.h>
 #include <gtkmm/applicationwindow.h>
 #include <gtkmm/cssprovider.h>
 #include <gtkmm/filedialog.h>
@@ -66,6 +77,16 @@
 #include <gtkmm/eventcontrollerkey.h>
 #include <gtkmm/listview.h>
 #include <gtkmm/selectionmodel.h>
+#include <gtkmm/notebook.h>
+#include <gtkmm/drawingarea.h>
+#include <gtkmm/spinbutton.h>
+#include <gtkmm/gestureclick.h>
+#include <gtkmm/gesturedrag.h>
+#include <gtkmm/eventcontrollerscroll.h>
+
+#include <gdkmm/frameclock.h>
+
+#include <cairomm/context.h>
 
 #include <nil/crypto3/zk/snark/arithmetization/plonk/gate.hpp>
 #include <nil/crypto3/zk/snark/arithmetization/plonk/copy_constraint.hpp>
@@ -75,37 +96,24 @@
 #include <nil/crypto3/zk/math/expression_visitors.hpp>
 
 #include "parsers.hpp"
+#include "store.hpp"
+#include "circuit.hpp"
+#include "constraint_index.hpp"
+#include "expression_dag.hpp"
+#include "evaluator.hpp"
+#include "search.hpp"
+#include "diff.hpp"
+#include "dependency_graph.hpp"
+#include "paged_table.hpp"
+#include "pipeline.hpp"
+#include "compression.hpp"
+#include "snapshot.hpp"
+#include "result_cache.hpp"
+#include "table_watch.hpp"
+#include "table_window.hpp"
+#include "shared_table.hpp"
 
 
-std::string read_line_from_gstream(Glib::RefPtr<Gio::FileInputStream> stream,
-                                   gsize predicted_line_size,
-                                   gsize file_size,
-                                   char* buffer) {
-    std::string line;
-    auto pos = stream->tell();
-    gsize total_read_size = pos;
-    if (pos + predicted_line_size >= file_size) {
-        predicted_line_size = file_size - pos;
-    }
-    char* newline = nullptr;
-    while (newline == nullptr && total_read_size != file_size) {
-        auto read_size = stream->read(buffer, predicted_line_size);
-        total_read_size += read_size;
-        buffer[read_size] = '\0';
-        if (read_size != predicted_line_size && total_read_size != file_size) {
-            return std::string("");
-        }
-        newline = strchr(buffer, '\n');
-        if (newline != nullptr) {
-            *newline = '\0';
-            stream->seek(total_read_size + (newline - buffer) + 1 - read_size, Glib::SeekType::SET);
-        }
-        line += buffer;
-    }
-
-    return line;
-}
-
 // Use this to debug in case you have no idea where a widget is
 void print_widget_hierarchy(const Gtk::Widget& widget, int depth = 0) {
     std::string indent(depth * 2, ' '); // Indentation based on depth
@@ -132,6 +140,7 @@ struct CellState {
     CellState(uint8_t state_) : state(state_) {}
     enum CellStateFlags : uint8_t {
         NORMAL = 0,
+        DIFFERENT = 1 << 0,
         SELECTED = 1 << 1,
         COPY_CONSTRAINED_SATISFIED = 1 << 2,
         COPY_CONSTRAINED_FAILURE = 1 << 3,
@@ -157,6 +166,18 @@ struct CellState {
         return state & SELECTED;
     }
 
+    void mark_different() {
+        state |= DIFFERENT;
+    }
+
+    void unmark_different() {
+        state &= ~DIFFERENT;
+    }
+
+    bool is_different() const {
+        return state & DIFFERENT;
+    }
+
     void remove_copy_constraint_state() {
         state &= ~(COPY_CONSTRAINED_SATISFIED | COPY_CONSTRAINED_FAILURE);
     }
@@ -204,219 +225,223 @@ struct CellState {
     uint8_t state;
 };
 
-template<typename BlueprintFieldType>
-struct cached_constraint {
-    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
-
-    cached_constraint() : constraint(nullptr), row(0), selector(0), constraint_num(0) {}
-    cached_constraint(plonk_constraint_type* constraint_, std::size_t row_,
-                      std::size_t selector_, std::size_t constraint_num_)
-        : constraint(constraint_), row(row_), selector(selector_), constraint_num(constraint_num_) {}
-
-    plonk_constraint_type* constraint;
-    std::size_t row;
-    std::size_t selector;
-    std::size_t constraint_num;
-};
-
 template <typename BlueprintFieldType>
 class row_object : public Glib::Object {
 public:
     // We have to roll a custom container for this because ArithmetizationParams are constexpr in the assignment table.
     using value_type = typename BlueprintFieldType::value_type;
     using integral_type = typename BlueprintFieldType::integral_type;
-    using plonk_copy_constraint_type = nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType>;
-    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
     using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
 
-    static Glib::RefPtr<row_object> create(const std::vector<integral_type>& row_, std::size_t row_index_) {
-        return Glib::make_refptr_for_instance<row_object>(new row_object(row_, row_index_));
+    static Glib::RefPtr<row_object> create(const std::shared_ptr<table_store<BlueprintFieldType>> &store_,
+                                           std::size_t row_index_) {
+        return Glib::make_refptr_for_instance<row_object>(new row_object(store_, row_index_));
     }
 
+    // Cells are formatted on first use, zero cells share a single string and are never formatted.
     const Glib::ustring& to_string(std::size_t index) const {
-        return string_cache[index];
+        static const Glib::ustring zero_string = "0";
+        if (index != 0 && store->is_zero(index - 1, row_index)) {
+            return zero_string;
+        }
+        if (string_cache.empty()) {
+            string_cache.resize(store->get_columns_amount() + 1);
+        }
+        Glib::ustring &cached = string_cache[index];
+        if (cached.empty()) {
+            if (index == 0) {
+                cached = std::to_string(store->get_window().first_row + row_index);
+            } else {
+                std::stringstream ss;
+                ss << std::hex << field_traits<BlueprintFieldType>::printable(store->get_cell(index - 1, row_index));
+                cached = ss.str();
+            }
+        }
+        return cached;
     }
 
     std::size_t get_row_index() const {
         return row_index;
     }
 
+    // Column 0 is the row index, the rest are the columns of the store shifted by one.
     const value_type get_row_item(std::size_t column_index) const {
-        return row[column_index];
+        if (column_index == 0) {
+            return value_type(integral_type(store->get_window().first_row + row_index));
+        }
+        return store->get(column_index - 1, row_index);
     }
 
     void set_row_item(const value_type& v, std::size_t column_index) {
-        row[column_index] = v;
+        store->set(column_index - 1, row_index, v);
+        forget_string(column_index);
+    }
 
-        std::stringstream ss;
-        if (column_index != 0) {
-            ss << std::hex;
-        } else {
-            ss << std::dec;
+    // Drops the formatted cell, for cells changed in the store directly.
+    void forget_string(std::size_t column_index) {
+        if (!string_cache.empty()) {
+            string_cache[column_index].clear();
         }
-        ss << row[column_index].data;
-        string_cache[column_index] = ss.str();
     }
 
     void set_cell_state(std::size_t column_index, CellState state) {
+        allocate_view_state();
         cell_states[column_index] = state;
     }
 
     CellState get_cell_state(std::size_t column_index) const {
-        return cell_states[column_index];
+        return cell_states.empty() ? CellState() : cell_states[column_index];
     }
 
     CellState& get_cell_state(std::size_t column_index) {
+        allocate_view_state();
         return cell_states[column_index];
     }
 
     void set_widget(std::size_t column_index, Gtk::Button* widget) {
+        allocate_view_state();
         widgets[column_index] = widget;
     }
 
     Gtk::Button* get_widget(std::size_t column_index) const {
-        return widgets[column_index];
+        return widgets.empty() ? nullptr : widgets[column_index];
     }
 
     bool get_widget_loaded(std::size_t column_index) const {
-        return widget_loaded[column_index];
+        return !widget_loaded.empty() && widget_loaded[column_index];
     }
 
     void set_widget_loaded(std::size_t column_index, bool loaded) {
-        widget_loaded[column_index] = loaded;
-    }
-
-    static std::size_t get_actual_column_index(var variable, table_sizes &sizes) {
-        switch (variable.type) {
-            case var::column_type::witness:
-                return variable.index + 1;
-                break;
-            case var::column_type::public_input:
-                return variable.index + 1 + sizes.witnesses_size;
-                break;
-            case var::column_type::constant:
-                return variable.index + 1 + sizes.witnesses_size + sizes.public_inputs_size;
-                break;
-            case var::column_type::selector:
-                return variable.index + 1 + sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size;
-                break;
-            case var::column_type::uninitialized:
-                throw std::runtime_error("Attempted to get actual column index of uninitialized variable");
-        }
-    }
-
-    void add_copy_constraint_to_cache(var variable, std::size_t constraint_num,
-                                      plonk_copy_constraint_type* constraint,
-                                      table_sizes &sizes) {
-        if (variable.rotation != row_index) {
-            std::cerr << "Attempted to add copy constraint to wrong row" << std::endl;
+        if (widget_loaded.empty() && !loaded) {
             return;
         }
-        std::size_t actual_column_index = get_actual_column_index(variable, sizes);
-        copy_constraints_cache[actual_column_index].push_back(std::make_pair(constraint_num, constraint));
-    }
-
-    std::size_t get_copy_constraints_size(std::size_t column_index) const {
-        return copy_constraints_cache[column_index].size();
-    }
-
-    std::pair<std::size_t, plonk_copy_constraint_type*> get_copy_constraint(std::size_t column_index,
-                                                                            std::size_t index) const {
-        return copy_constraints_cache[column_index][index];
+        allocate_view_state();
+        widget_loaded[column_index] = loaded;
     }
 
-    std::size_t get_constraints_size(std::size_t column_index) const {
-        return constraints_cache[column_index].size();
+    static std::size_t get_actual_column_index(var variable, const table_sizes &sizes) {
+        return table_store<BlueprintFieldType>::get_column_index(variable, sizes) + 1;
     }
 
-    cached_constraint<BlueprintFieldType> get_constraint(std::size_t column_index, std::size_t index) const {
-        return constraints_cache[column_index][index];
+    bool selector_enabled(std::size_t selector_num) const {
+        return store->selector_enabled(selector_num, row_index);
     }
 
-    void add_constraint_to_cache(row_object<BlueprintFieldType>* previous_row,
-                                 row_object<BlueprintFieldType>* next_row,
-                                 var variable, std::size_t selector, std::size_t constraint_num, std::size_t row,
-                                 plonk_constraint_type* constraint, table_sizes &sizes) {
-        if (variable.rotation == 1) {
-            variable.rotation = 0;
-            if (next_row == nullptr) {
-                std::cerr << "Attempted to add constraint " << constraint_num << " from selector "
-                          << selector << " to non-existent row " << row + 1 << std::endl;
-                return;
-            }
-            next_row->add_constraint_to_cache(nullptr, nullptr, variable, selector, constraint_num, row, constraint, sizes);
-            return;
-        } else if (variable.rotation == -1) {
-            variable.rotation = 0;
-            if (previous_row == nullptr) {
-                std::cerr << "Attempted to add constraint " << constraint_num << " from selector "
-                          << selector << " to non-existent row " << row - 1 << std::endl;
-                return;
-            }
-            previous_row->add_constraint_to_cache(nullptr, nullptr, variable, selector,
-                                                  constraint_num, row, constraint, sizes);
+    // Constraint highlights are only valid in the generation they were made in, so clearing all of them is
+    // a counter increment. Stale highlights of the row are dropped the first time it is looked at.
+    void sync_highlight_generation(std::uint32_t generation) {
+        if (highlight_generation == generation) {
             return;
         }
-        std::size_t actual_column_index = get_actual_column_index(variable, sizes);
-        constraints_cache[actual_column_index].push_back(
-            cached_constraint<BlueprintFieldType>(constraint, row, selector, constraint_num));
+        for (CellState &state : cell_states) {
+            state.remove_copy_constraint_state();
+            state.remove_gate_constraint_state();
+        }
+        highlight_generation = generation;
     }
 
-    bool selector_enabled(std::size_t selector_num, table_sizes &sizes) {
-        return row[1 + sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + selector_num] != 0;
+    // Whether any cell is selected, marked as different or highlighted in the given generation.
+    bool has_cell_marks(std::uint32_t generation) const {
+        const std::uint8_t highlights = CellState::COPY_CONSTRAINED_SATISFIED | CellState::COPY_CONSTRAINED_FAILURE |
+                                        CellState::GATE_CONSTRAINED_SATISFIED | CellState::GATE_CONSTRAINED_FAILURE;
+        const std::uint8_t ignored = highlight_generation == generation ? 0 : highlights;
+        return std::any_of(cell_states.begin(), cell_states.end(),
+                           [ignored](const CellState &state) { return (state.state & ~ignored) != 0; });
     }
 
 protected:
-    row_object(const std::vector<integral_type>& row_, std::size_t row_index_) :
-            row_index(row_index_), cell_states(row_.size(), CellState::CellStateFlags::NORMAL),
-            widgets(row_.size(), nullptr), widget_loaded(row_.size(), false),
-            copy_constraints_cache(row_.size()), constraints_cache(row_.size()) {
-        row.reserve(row_.size());
-        std::copy(row_.begin(), row_.end(), std::back_inserter(row));
-        string_cache.reserve(row.size());
-
-        for (std::size_t i = 0; i < row.size(); ++i) {
-            std::stringstream ss;
-            if (i != 0) {
-                ss << std::hex;
-            } else {
-                ss << std::dec;
-            }
-            ss << row[i].data;
-            string_cache.push_back(ss.str());
+    row_object(const std::shared_ptr<table_store<BlueprintFieldType>> &store_, std::size_t row_index_) :
+            row_index(row_index_), store(store_), highlight_generation(0) {}
+private:
+    // Most rows are never shown or highlighted, so the state of their cells is only allocated on first use.
+    void allocate_view_state() {
+        if (cell_states.empty()) {
+            cell_states.assign(store->get_columns_amount() + 1, CellState::CellStateFlags::NORMAL);
+            widgets.assign(store->get_columns_amount() + 1, nullptr);
+            widget_loaded.assign(store->get_columns_amount() + 1, false);
         }
     }
-private:
+
+
     std::size_t row_index;
+    // The values themselves live in the store, row_object only keeps what the view needs.
+    std::shared_ptr<table_store<BlueprintFieldType>> store;
     std::vector<CellState> cell_states;
     std::vector<Gtk::Button*> widgets;
     std::vector<bool> widget_loaded;
-    // Stores all copy constraints which affect the i'th item
-    // The size element in pair is for constraint num in container.
-    std::vector<std::vector<std::pair<std::size_t, plonk_copy_constraint_type*>>> copy_constraints_cache;
-    // Stores all constraints which affect the i'th item, with their selectors and constraint numbers.
-    std::vector<std::vector<cached_constraint<BlueprintFieldType>>> constraints_cache;
-    std::vector<Glib::ustring> string_cache;
-    std::vector<value_type> row;
-    // Using the model to traverse for gate constraints is annoying, we use previous/next pointers to make it easier.
-    row_object *previous, *next;
+    std::uint32_t highlight_generation;
+    mutable std::vector<Glib::ustring> string_cache;
 };
 
+// Rows of the table view. Row objects are only made for the rows the view asks for, and dropped again
+// once nothing but the model refers to them and none of their cells are marked, so the amount of objects
+// depends on what is shown and marked rather than on the size of the table.
+// A row keeps the same object for as long as anything refers to it.
 template<typename BlueprintFieldType>
-struct circuit_container {
-    // We have to roll a custom container for this because ArithmetizationParams are constexpr in the circuit.
-    using plonk_constraint_type = nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>;
-    using plonk_gate_type = nil::crypto3::zk::snark::plonk_gate<BlueprintFieldType, plonk_constraint_type>;
-    using plonk_copy_constraint_type = nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType>;
+class row_model : public Glib::Object, public Gio::ListModel {
+public:
+    using row_type = row_object<BlueprintFieldType>;
+
+    static Glib::RefPtr<row_model> create(const std::shared_ptr<table_store<BlueprintFieldType>> &store_) {
+        return Glib::make_refptr_for_instance<row_model>(new row_model(store_));
+    }
+
+    // Highlights of older generations are stale and do not keep rows alive.
+    void set_highlight_generation(std::uint32_t generation) {
+        highlight_generation = generation;
+    }
+
+    std::size_t get_cached_rows_amount() const {
+        return rows.size();
+    }
+
+protected:
+    row_model(const std::shared_ptr<table_store<BlueprintFieldType>> &store_) :
+            Glib::ObjectBase(typeid(row_model)), Glib::Object(), Gio::ListModel(),
+            store(store_), highlight_generation(0), sweep_size(min_sweep_size) {}
+
+    GType get_item_type_vfunc() override {
+        return G_TYPE_OBJECT;
+    }
+
+    guint get_n_items_vfunc() override {
+        return guint(store->get_rows_amount());
+    }
+
+    gpointer get_item_vfunc(guint position) override {
+        if (position >= store->get_rows_amount()) {
+            return nullptr;
+        }
+        auto it = rows.find(position);
+        if (it == rows.end()) {
+            if (rows.size() >= sweep_size) {
+                drop_unused_rows();
+            }
+            it = rows.emplace(position, row_type::create(store, position)).first;
+        }
+        // The caller owns the returned reference.
+        return g_object_ref(it->second->gobj());
+    }
+
+private:
+    static constexpr std::size_t min_sweep_size = 4096;
 
-    circuit_sizes sizes;
-    std::vector<plonk_gate_type> gates;
-    std::vector<plonk_copy_constraint_type> copy_constraints;
-    // TODO: add lookup gates
+    void drop_unused_rows() {
+        for (auto it = rows.begin(); it != rows.end();) {
+            if (G_OBJECT(it->second->gobj())->ref_count == 1 && !it->second->has_cell_marks(highlight_generation)) {
+                it = rows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // Rows which have to stay should not make every following lookup sweep again.
+        sweep_size = std::max(min_sweep_size, rows.size() * 2);
+    }
 
-    // This is used in order to be able to travers from copy constraint to the underlying variable and it's cell.
-    // We can utilise this in tandem with links from row_object to constraints to traverse and colour.
-    std::vector<std::pair<row_object<BlueprintFieldType>*, row_object<BlueprintFieldType>*>> copy_constraints_links;
+    std::shared_ptr<table_store<BlueprintFieldType>> store;
+    std::unordered_map<guint, Glib::RefPtr<row_type>> rows;
+    std::uint32_t highlight_generation;
+    std::size_t sweep_size;
 };
 
 template<typename BlueprintFieldType>
@@ -426,25 +451,25 @@ struct constraint_object : public Glib::Object {
     using plonk_copy_constraint_type = nil::crypto3::zk::snark::plonk_copy_constraint<BlueprintFieldType>;
 
     static Glib::RefPtr<constraint_object> create(plonk_constraint_type* constraint_, std::size_t row_,
-                                                  std::size_t selector, std::size_t num) {
+                                                  std::size_t gate_, std::size_t num) {
         return Glib::make_refptr_for_instance<constraint_object>(
-            new constraint_object(constraint_, row_, selector, num));
+            new constraint_object(constraint_, row_, gate_, num));
     }
 
     static Glib::RefPtr<constraint_object> create(plonk_copy_constraint_type* constraint_) {
         return Glib::make_refptr_for_instance<constraint_object>(new constraint_object(constraint_));
     }
 
-    constraint_object(plonk_constraint_type* constraint_, std::size_t row_, std::size_t selector, std::size_t num) :
-            constraint(constraint_), loaded(false), row(row_), button(nullptr) {
+    constraint_object(plonk_constraint_type* constraint_, std::size_t row_, std::size_t gate_, std::size_t num) :
+            constraint(constraint_), loaded(false), row(row_), gate(gate_), constraint_num(num), button(nullptr) {
         std::stringstream ss;
-        ss << "cons " << selector << " " << num << ": ";
+        ss << "cons " << gate_ << " " << num << ": ";
         ss << *constraint_;
         cached_string = ss.str();
     }
 
     constraint_object(plonk_copy_constraint_type* constraint_)
-            : constraint(constraint_), loaded(false), row(-1), button(nullptr) {
+            : constraint(constraint_), loaded(false), row(-1), gate(-1), constraint_num(-1), button(nullptr) {
         std::stringstream ss;
         ss << "copy " << constraint_->first << " " << constraint_->second;
         cached_string = ss.str();
@@ -472,6 +497,8 @@ struct constraint_object : public Glib::Object {
     bool loaded;
     // Used for gate constraints to access the correct row for highlighting.
     std::size_t row;
+    // Position of a gate constraint in the circuit, used to find it in the expression DAG.
+    std::size_t gate, constraint_num;
     Gtk::Button* button;
 };
 
@@ -490,6 +517,33 @@ struct CellTracker {
     TrackedType* tracked_object;
 };
 
+// Settings of the window which come from the command line.
+struct viewer_options {
+    // Memory for the values of a table in MiB. Tables are read as a whole if it is 0,
+    // otherwise they are paged in from the file as they are accessed.
+    int paged_memory = 0;
+    // Only the row offsets are found when a table is opened, rows are parsed when they are first needed
+    // and worker threads parse the rest meanwhile. Not used together with paged_memory.
+    bool lazy_parsing = false;
+    // Results of checks are kept in this directory between runs and only the gates reading changed row blocks
+    // are evaluated again. Nothing is kept if it is empty.
+    std::string result_cache_dir;
+    // Opened table files are read again when they change, only the changed row blocks are parsed.
+    // Not used together with paged_memory and lazy_parsing.
+    bool watch_table = false;
+    // Shared memory segment a prover process wrote a table into, see shared_table.hpp. The table is opened
+    // at startup if it is not empty, and paged in from the segment within paged_memory if that is set.
+    std::string shared_table;
+    // Only this part of opened tables is loaded if window_rows_amount is not 0 or window_columns is not empty,
+    // see table_window.hpp. Not used together with paged_memory, lazy_parsing and watch_table.
+    std::size_t window_first_row = 0;
+    std::size_t window_rows_amount = 0;
+    std::string window_columns;
+
+    bool has_window() const {
+        return window_first_row != 0 || window_rows_amount != 0 || !window_columns.empty();
+    }
+};
 
 template<typename BlueprintFieldType>
 class ExcaliburWindow : public Gtk::ApplicationWindow {
@@ -501,10 +555,14 @@ public:
     using plonk_gate_type = nil::crypto3::zk::snark::plonk_gate<BlueprintFieldType, plonk_constraint_type>;
     using var = nil::crypto3::zk::snark::plonk_variable<value_type>;
 
-    ExcaliburWindow() : table_view(), element_entry(), vbox_prime(), vbox_controls(), table_window(),
+    ExcaliburWindow(const viewer_options &options_ = viewer_options()) :
+                        table_view(), element_entry(), vbox_prime(), vbox_controls(), table_window(),
                         open_table_button("Open Table"),  open_circuit_button("Open Circuit"),
-                        save_table_button("Save"),
-                        constraints_view(), constraints_window() {
+                        save_table_button("Save"), diff_table_button("Diff"), check_circuit_button("Check"),
+                        save_session_button("Save Session"), open_session_button("Open Session"),
+                        search_prev_button("<"), search_next_button(">"),
+                        constraints_view(), constraints_window(), graph_hops_label("Hops"),
+                        graph_hops_button(Gtk::Adjustment::create(1, 1, 5)), options(options_) {
         set_title("Excalibur Circuit Viewer: pull the bugs from the stone");
         set_resizable(true);
 
@@ -516,7 +574,8 @@ public:
             "button.copy_satisfied { background: #58D68D; }"
             "button.copy_unsatisfied { background: crimson; }"
             "button.gate_satisfied { background: limegreen; }"
-            "button.gate_unsatisfied { background: darkred; }";
+            "button.gate_unsatisfied { background: darkred; }"
+            "button.diff { color: darkorange; font-weight: bold; }";
         css_provider->load_from_data(css_style);
         Gtk::StyleProvider::add_provider_for_display(
             Gdk::Display::get_default(), css_provider, GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -531,18 +590,48 @@ public:
         vbox_controls.set_orientation(Gtk::Orientation::HORIZONTAL);
         vbox_controls.append(open_table_button);
         vbox_controls.append(save_table_button);
+        vbox_controls.append(diff_table_button);
         vbox_controls.append(open_circuit_button);
+        vbox_controls.append(check_circuit_button);
+        vbox_controls.append(save_session_button);
+        vbox_controls.append(open_session_button);
         vbox_controls.append(element_entry);
         vbox_prime.append(vbox_controls);
 
+        search_entry.set_placeholder_text("Find: value, low..high or nonzero, optionally after columns as in W0,P1:");
+        search_entry.set_hexpand(true);
+        hbox_search.set_spacing(10);
+        hbox_search.set_orientation(Gtk::Orientation::HORIZONTAL);
+        hbox_search.append(search_entry);
+        hbox_search.append(search_prev_button);
+        hbox_search.append(search_next_button);
+        hbox_search.append(search_label);
+        vbox_prime.append(hbox_search);
+
         table_window.set_child(table_view);
+        table_window.get_vadjustment()->signal_value_changed().connect(
+            sigc::mem_fun(*this, &ExcaliburWindow::on_table_scrolled));
         table_window.set_size_request(800, 600);
         table_window.set_vexpand(true);
         vbox_prime.append(table_window);
 
         constraints_window.set_child(constraints_view);
         constraints_window.set_size_request(-1, 128);
-        vbox_prime.append(constraints_window);
+        details_notebook.append_page(constraints_window, "Constraints");
+
+        hbox_graph.set_spacing(10);
+        hbox_graph.set_orientation(Gtk::Orientation::HORIZONTAL);
+        hbox_graph.append(graph_hops_label);
+        hbox_graph.append(graph_hops_button);
+        hbox_graph.append(graph_label);
+        graph_box.set_orientation(Gtk::Orientation::VERTICAL);
+        graph_box.append(hbox_graph);
+        graph_area.set_size_request(-1, 256);
+        graph_area.set_vexpand(true);
+        graph_area.set_draw_func(sigc::mem_fun(*this, &ExcaliburWindow::on_draw_graph));
+        graph_box.append(graph_area);
+        details_notebook.append_page(graph_box, "Graph");
+        vbox_prime.append(details_notebook);
         vbox_prime.set_vexpand(true);
 
         set_child(vbox_prime);
@@ -553,11 +642,52 @@ public:
             sigc::mem_fun(*this, &ExcaliburWindow::on_entry_key_released), true);
         element_entry.add_controller(key_controller);
 
+        // Click on a node expands it, double click on a cell selects it in the table.
+        auto graph_click = Gtk::GestureClick::create();
+        graph_click->signal_pressed().connect(sigc::mem_fun(*this, &ExcaliburWindow::on_graph_pressed));
+        graph_area.add_controller(graph_click);
+        auto graph_drag = Gtk::GestureDrag::create();
+        graph_drag->signal_drag_begin().connect([this](double, double) {
+            graph_drag_start_x = graph_offset_x;
+            graph_drag_start_y = graph_offset_y;
+        });
+        graph_drag->signal_drag_update().connect([this](double offset_x, double offset_y) {
+            graph_offset_x = graph_drag_start_x + offset_x;
+            graph_offset_y = graph_drag_start_y + offset_y;
+            graph_area.queue_draw();
+        });
+        graph_area.add_controller(graph_drag);
+        auto graph_scroll = Gtk::EventControllerScroll::create();
+        graph_scroll->set_flags(Gtk::EventControllerScroll::Flags::VERTICAL);
+        graph_scroll->signal_scroll().connect([this](double, double dy) {
+            graph_scale = std::clamp(graph_scale * (dy < 0 ? 1.1 : 1 / 1.1), 0.05, 4.0);
+            graph_area.queue_draw();
+            return true;
+        }, false);
+        graph_area.add_controller(graph_scroll);
+
         open_table_button.signal_clicked().connect(sigc::mem_fun(*this, &ExcaliburWindow::on_action_table_file_open));
         open_circuit_button.signal_clicked().connect(
             sigc::mem_fun(*this, &ExcaliburWindow::on_action_circuit_file_open));
         save_table_button.signal_clicked().connect(
             sigc::bind<0>(sigc::mem_fun(*this, &ExcaliburWindow::on_action_table_file_save), false));
+        diff_table_button.signal_clicked().connect(sigc::mem_fun(*this, &ExcaliburWindow::on_action_table_diff));
+        check_circuit_button.signal_clicked().connect(
+            sigc::mem_fun(*this, &ExcaliburWindow::on_action_circuit_check));
+        save_session_button.signal_clicked().connect(
+            sigc::mem_fun(*this, &ExcaliburWindow::on_action_session_save));
+        open_session_button.signal_clicked().connect(
+            sigc::mem_fun(*this, &ExcaliburWindow::on_action_session_open));
+        search_entry.signal_activate().connect(sigc::mem_fun(*this, &ExcaliburWindow::on_search));
+        search_prev_button.signal_clicked().connect(
+            sigc::bind<0>(sigc::mem_fun(*this, &ExcaliburWindow::on_search_step), -1));
+        search_next_button.signal_clicked().connect(
+            sigc::bind<0>(sigc::mem_fun(*this, &ExcaliburWindow::on_search_step), 1));
+        pages_loaded_dispatcher.connect(sigc::mem_fun(*this, &ExcaliburWindow::on_pages_loaded));
+
+        if (!options.shared_table.empty()) {
+            Glib::signal_idle().connect_once([this]() { open_shared_table(options.shared_table); });
+        }
     }
 
     ~ExcaliburWindow() override {};
@@ -580,18 +710,75 @@ public:
     }
 
     void clear_highlights() {
-        for (auto &cell : highlighted_cells) {
-            auto row = cell.tracked_object;
-            CellState &row_state = row->get_cell_state(cell.column);
-            row_state.remove_copy_constraint_state();
-            if (row->get_widget_loaded(cell.column)) {
-                auto button = row->get_widget(cell.column);
-                button->remove_css_class("copy_satisfied");
-                button->remove_css_class("copy_unsatisfied");
-                button->remove_css_class("gate_satisfied");
-                button->remove_css_class("gate_unsatisfied");
+        highlight_generation++;
+        if (rows_model) {
+            rows_model->set_highlight_generation(highlight_generation);
+        }
+        restyle_bound_cells = true;
+        schedule_style_update();
+    }
+
+    // Css classes of the cell buttons are not touched right away: every class change invalidates the style
+    // of the button, and highlighting a gate or a copy constraint may touch a lot of cells.
+    // Changed cells are queued instead, and a tick callback brings the buttons of the queued cells which
+    // are on screen in line with their state at the next frame, setting all the classes of a button at once.
+    void queue_cell_style(row_object<BlueprintFieldType>* row, std::size_t column) {
+        // Queued rows are held on to, the row model drops the rows nothing refers to.
+        row->reference();
+        pending_style_cells.emplace_back(Glib::make_refptr_for_instance(row), column);
+        schedule_style_update();
+    }
+
+    void schedule_style_update() {
+        if (style_tick_id == 0) {
+            style_tick_id = table_view.add_tick_callback(sigc::mem_fun(*this, &ExcaliburWindow::on_style_tick));
+        }
+    }
+
+    bool on_style_tick(const Glib::RefPtr<Gdk::FrameClock>&) {
+        if (restyle_bound_cells) {
+            for (const auto &[button, cell] : bound_cells) {
+                apply_cell_style(button, cell.first, cell.second);
+            }
+        } else {
+            for (const auto &[row, column] : pending_style_cells) {
+                if (row->get_widget_loaded(column)) {
+                    apply_cell_style(row->get_widget(column), row.get(), column);
+                }
             }
         }
+        pending_style_cells.clear();
+        restyle_bound_cells = false;
+        style_tick_id = 0;
+        return false;
+    }
+
+    void apply_cell_style(Gtk::Button* button, row_object<BlueprintFieldType>* row, std::size_t column) {
+        static const std::array<std::pair<std::uint8_t, const char*>, 6> state_classes = {{
+            {CellState::SELECTED, "selected"},
+            {CellState::COPY_CONSTRAINED_SATISFIED, "copy_satisfied"},
+            {CellState::COPY_CONSTRAINED_FAILURE, "copy_unsatisfied"},
+            {CellState::GATE_CONSTRAINED_SATISFIED, "gate_satisfied"},
+            {CellState::GATE_CONSTRAINED_FAILURE, "gate_unsatisfied"},
+            {CellState::DIFFERENT, "diff"}}};
+        row->sync_highlight_generation(highlight_generation);
+        const CellState state = row->get_cell_state(column);
+        const std::vector<Glib::ustring> old_classes = button->get_css_classes();
+        std::vector<Glib::ustring> classes;
+        for (const Glib::ustring &css_class : old_classes) {
+            auto is_state_class = [&css_class](const auto &entry) { return css_class == entry.second; };
+            if (std::none_of(state_classes.begin(), state_classes.end(), is_state_class)) {
+                classes.push_back(css_class);
+            }
+        }
+        for (const auto &[flag, css_class] : state_classes) {
+            if (state.state & flag) {
+                classes.push_back(css_class);
+            }
+        }
+        if (classes != old_classes) {
+            button->set_css_classes(classes);
+        }
     }
 
     void highlight_constraint(constraint_object<BlueprintFieldType>* constraint_item) {
@@ -600,54 +787,28 @@ public:
         auto constraint = constraint_item->constraint;
         if (constraint.which() == 0) { // gate constraint
             std::size_t row_idx = constraint_item->row;
-            auto gate_constraint =
-                boost::get<nil::crypto3::zk::snark::plonk_constraint<BlueprintFieldType>*>(constraint);
-            auto previous_row = (row_idx > 0) ?
-                dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(row_idx - 1))
-                : nullptr;
-            auto curent_row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(row_idx));
-            auto next_row = (row_idx < sizes.max_size) ?
-                dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(row_idx + 1))
-                : nullptr;
-            std::set<var> variable_set;
-            std::function<void(var)> variable_extractor =
-                [&variable_set](var variable) { variable_set.insert(variable); };
-            nil::crypto3::math::expression_for_each_variable_visitor<var> visitor(variable_extractor);
-            visitor.visit(*gate_constraint);
-
-            std::map<std::tuple<std::size_t, int, typename var::column_type>, typename var::assignment_type>
-                evaluation_map;
-            for (const var &variable : variable_set) {
-                row_object<BlueprintFieldType> *var_row = variable.rotation == -1 ? previous_row :
-                                                          variable.rotation == 0 ? curent_row : next_row;
-                auto column = var_row->get_actual_column_index(variable, sizes);
-                evaluation_map[std::make_tuple(variable.index, variable.rotation, variable.type)] =
-                    var_row->get_row_item(column);
+            bool satisfied;
+            try {
+                satisfied = dag.evaluate(*store, constraint_item->gate, constraint_item->constraint_num, row_idx) == 0;
+            } catch (const std::out_of_range &e) {
+                std::cerr << e.what() << std::endl;
+                return;
             }
-            bool satisfied = gate_constraint->evaluate(evaluation_map) == 0;
 
-            for (const var &variable : variable_set) {
-                row_object<BlueprintFieldType> *var_row = variable.rotation == -1 ? previous_row :
-                                                          variable.rotation == 0 ? curent_row : next_row;
-                std::size_t var_row_idx = variable.rotation == -1 ? row_idx - 1 :
-                                          variable.rotation == 0 ? row_idx : row_idx + 1;
+            for (const var &variable : dag.get_constraint_variables(constraint_item->gate,
+                                                                    constraint_item->constraint_num)) {
+                // Evaluation has already checked that all the rows are inside of the table.
+                std::size_t var_row_idx = row_idx + variable.rotation;
+                auto var_row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(var_row_idx));
                 auto column = var_row->get_actual_column_index(variable, sizes);
+                var_row->sync_highlight_generation(highlight_generation);
                 CellState &row_state = var_row->get_cell_state(column);
                 if (satisfied) {
                     row_state.gate_constraint_satisfied();
                 } else {
                     row_state.gate_constraint_unsatisfied();
                 }
-                if (var_row->get_widget_loaded(column)) {
-                    auto button = var_row->get_widget(column);
-                    if (satisfied) {
-                        button->add_css_class("gate_satisfied");
-                    } else {
-                        button->add_css_class("gate_unsatisfied");
-                    }
-                }
-                highlighted_cells.push_back(CellTracker<Gtk::Button, row_object<BlueprintFieldType>>(
-                    var_row_idx, column, var_row));
+                queue_cell_style(var_row, column);
             }
         } else if (constraint.which() == 1) { // copy constraint
             auto copy_constraint =
@@ -655,7 +816,14 @@ public:
             std::array<var, 2> vars = {copy_constraint->first, copy_constraint->second};
             std::array<typename BlueprintFieldType::value_type, 2> values;
             for (std::size_t i = 0; i < 2; i++) {
-                auto row_index = vars[i].rotation;
+                if (!store->get_window().is_column_loaded(store->get_column_index(vars[i]))) {
+                    std::cerr << "The copy constraint refers to a column which is not loaded" << std::endl;
+                    return;
+                }
+            }
+            for (std::size_t i = 0; i < 2; i++) {
+                // Rows of copy constraints are rows of the whole table.
+                auto row_index = store->get_store_row(vars[i].rotation);
                 auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(row_index));
                 if (!row) {
                     std::cerr << "Failed to get row" << std::endl;
@@ -665,29 +833,21 @@ public:
                 values[i] = row->get_row_item(column);
             }
             for (std::size_t i = 0; i < 2; i++) {
-                auto row_index = vars[i].rotation;
+                auto row_index = store->get_store_row(vars[i].rotation);
                 auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(row_index));
                 if (!row) {
                     std::cerr << "Failed to get row" << std::endl;
                     return;
                 }
                 auto column = row->get_actual_column_index(vars[i], sizes);
+                row->sync_highlight_generation(highlight_generation);
                 CellState &row_state = row->get_cell_state(column);
                 if (values[0] == values[1]) {
                     row_state.copy_constraint_satisfied();
-                    if (row->get_widget_loaded(column)) {
-                        auto button = row->get_widget(column);
-                        button->add_css_class("copy_satisfied");
-                    }
                 } else {
                     row_state.copy_constraint_unsatisfied();
-                    if (row->get_widget_loaded(column)) {
-                        auto button = row->get_widget(column);
-                        button->add_css_class("copy_unsatisfied");
-                    }
                 }
-                highlighted_cells.push_back(CellTracker<Gtk::Button, row_object<BlueprintFieldType>>(
-                    vars[i].rotation, column, row));
+                queue_cell_style(row, column);
             }
         } else {
             std::cerr << "Unimplemented constraint type" << std::endl;
@@ -705,6 +865,26 @@ public:
                           file_dialog));
     }
 
+    void on_action_table_diff() {
+        if (!store) {
+            std::cerr << "Open a table to compare with first" << std::endl;
+            return;
+        }
+        // Columns which are not loaded read as zeroes and would all show up as differences.
+        if (!store->get_window().is_whole()) {
+            std::cerr << "Only whole tables can be compared" << std::endl;
+            return;
+        }
+        auto file_dialog = Gtk::FileDialog::create();
+        file_dialog->set_modal(true);
+        file_dialog->set_title("Open table file to compare with");
+        file_dialog->set_initial_folder(Gio::File::create_for_path(std::string(std::filesystem::current_path())));
+        file_dialog->open(*this,
+            sigc::bind<0>(sigc::mem_fun(*this,
+                                        &ExcaliburWindow::on_table_diff_dialog_response),
+                          file_dialog));
+    }
+
     void on_action_circuit_file_open() {
         auto file_dialog = Gtk::FileDialog::create();
         file_dialog->set_modal(true);
@@ -716,6 +896,62 @@ public:
                           file_dialog));
     }
 
+    // Evaluates all the gates over the whole table and lists the failed constraints.
+    void on_action_circuit_check() {
+        if (!store || circuit.gates.empty()) {
+            std::cerr << "Load a table and a circuit first" << std::endl;
+            return;
+        }
+        // Results for a part of a table are not kept, they would replace those for the whole one.
+        if (options.result_cache_dir.empty() || !store->get_window().is_whole()) {
+            check_result = evaluator.check(*store);
+            check_blocks.clear();
+        } else {
+            cached_check_stats stats;
+            check_result = cached_check(options.result_cache_dir, circuit_hash, evaluator, *store, check_blocks,
+                                        stats);
+            std::cout << "Reused earlier results for " << stats.reused_row_blocks << " of " << stats.row_blocks
+                      << " row blocks" << std::endl;
+        }
+        check_version = store->get_version();
+        has_check_result = true;
+        show_check_result();
+    }
+
+    void show_check_result() {
+        std::cout << "Checked " << check_result.evaluations << " constraint evaluations, "
+                  << check_result.failures.size() << " failed" << std::endl;
+        if (check_result.out_of_table_rows != 0 && !store->get_window().is_whole()) {
+            std::cout << check_result.out_of_table_rows << " enabled gate rows refer to cells outside of the loaded "
+                      << "part of the table and were skipped" << std::endl;
+        } else if (check_result.out_of_table_rows != 0) {
+            std::cerr << check_result.out_of_table_rows << " enabled gate rows refer to cells outside of the table "
+                      << "and were skipped" << std::endl;
+        }
+
+        clear_highlights();
+        if (selected_constraint.tracked_object != nullptr) {
+            selected_constraint.tracked_object->deselect();
+            selected_constraint.tracked_object = nullptr;
+        }
+        // Listing millions of constraints would only make the view unusable.
+        const std::size_t max_listed_failures = 10000;
+        if (check_result.failures.size() > max_listed_failures) {
+            std::cout << "Listing the first " << max_listed_failures << " failed constraints" << std::endl;
+        }
+        auto failures_store = Gio::ListStore<constraint_object<BlueprintFieldType>>::create();
+        const std::size_t listed = std::min(check_result.failures.size(), max_listed_failures);
+        for (std::size_t i = 0; i < listed; i++) {
+            const auto &failure = check_result.failures[i];
+            auto item = constraint_object<BlueprintFieldType>::create(
+                &circuit.gates[failure.gate].constraints[failure.constraint_num],
+                failure.row, failure.gate, failure.constraint_num);
+            item->state.gate_constraint_unsatisfied();
+            failures_store->append(item);
+        }
+        setup_constraint_view_from_store(failures_store);
+    }
+
     void on_action_table_file_save(bool wide_export) {
         auto file_dialog = Gtk::FileDialog::create();
         file_dialog->set_modal(true);
@@ -726,6 +962,94 @@ public:
                           wide_export));
     }
 
+    void on_action_session_save() {
+        if (!store) {
+            std::cerr << "Open a table first" << std::endl;
+            return;
+        }
+        if (!store->get_window().is_whole()) {
+            std::cerr << "Sessions can only be saved for whole tables" << std::endl;
+            return;
+        }
+        auto file_dialog = Gtk::FileDialog::create();
+        file_dialog->set_modal(true);
+        file_dialog->set_title("Save session snapshot");
+        file_dialog->save(*this,
+            sigc::bind<0>(sigc::mem_fun(*this, &ExcaliburWindow::on_session_save_dialog_response), file_dialog));
+    }
+
+    void on_action_session_open() {
+        auto file_dialog = Gtk::FileDialog::create();
+        file_dialog->set_modal(true);
+        file_dialog->set_title("Open session snapshot");
+        file_dialog->set_initial_folder(Gio::File::create_for_path(std::string(std::filesystem::current_path())));
+        file_dialog->open(*this,
+            sigc::bind<0>(sigc::mem_fun(*this, &ExcaliburWindow::on_session_open_dialog_response), file_dialog));
+    }
+
+    // The snapshot keeps the values of the store, edits included, and is keyed on the hashes of the files
+    // the table and the circuit were read from.
+    void on_session_save_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
+                                         std::shared_ptr<Gio::AsyncResult> &res) {
+        auto result = file_dialog->save_finish(res);
+        if (result->get_path().empty()) {
+            std::cerr << "Session snapshots can only be saved to local files" << std::endl;
+            return;
+        }
+        const bool check_valid = has_check_result && check_version == store->get_version();
+        try {
+            save_session_snapshot(result->get_path(), *store, circuit, dag, index,
+                                  check_valid ? &check_result : nullptr,
+                                  describe_source_file(table_path), describe_source_file(circuit_path));
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+        std::cout << "Saved the session to " << result->get_path() << std::endl;
+    }
+
+    void on_session_open_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
+                                         std::shared_ptr<Gio::AsyncResult> &res) {
+        auto result = file_dialog->open_finish(res);
+        if (result->get_path().empty()) {
+            std::cerr << "Session snapshots can only be opened from local files" << std::endl;
+            return;
+        }
+        session_snapshot<BlueprintFieldType> session;
+        try {
+            load_session_snapshot(result->get_path(), session);
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+        for (const snapshot_source *source : {&session.table_source, &session.circuit_source}) {
+            if (!source_unchanged(*source)) {
+                std::cerr << source->path << " has changed since the session was saved, "
+                          << "the snapshot shows it as it was then" << std::endl;
+            }
+        }
+
+        clear_circuit();
+        set_table(session.store);
+        table_path = session.table_source.path;
+        circuit = std::move(session.circuit);
+        circuit_path = session.circuit_source.path;
+        dag = std::move(session.dag);
+        index = std::move(session.index);
+        evaluator.build(dag, circuit);
+        circuit_hash = get_circuit_hash(circuit, dag);
+        if (!circuit.gates.empty()) {
+            print_circuit_stats();
+        }
+        if (session.has_check_result) {
+            check_result = std::move(session.check_result);
+            check_blocks.clear();
+            check_version = store->get_version();
+            has_check_result = true;
+            show_check_result();
+        }
+    }
+
     void on_setup_column_item(std::size_t column, const Glib::RefPtr<Gtk::ListItem> &list_item) {
         auto button = Gtk::make_managed<Gtk::Button>();
         auto label = Gtk::make_managed<Gtk::Label>();
@@ -763,22 +1087,8 @@ public:
         mitem->set_widget(column, button);
         mitem->set_widget_loaded(column, true);
         label->set_text(mitem->to_string(column));
-        CellState state = mitem->get_cell_state(column);
-        if (state.is_selected()) {
-            button->add_css_class("selected");
-        }
-        if (state.is_copy_constraint_satisfied()) {
-            button->add_css_class("copy_satisfied");
-        }
-        if (state.is_copy_constraint_unsatisfied()) {
-            button->add_css_class("copy_unsatisfied");
-        }
-        if (state.is_gate_constraint_satisfied()) {
-            button->add_css_class("gate_satisfied");
-        }
-        if (state.is_gate_constraint_unsatisfied()) {
-            button->add_css_class("gate_unsatisfied");
-        }
+        apply_cell_style(button, mitem, column);
+        bound_cells[button] = std::make_pair(mitem, column);
     }
 
     void on_unbind_column_item(std::size_t column, const Glib::RefPtr<Gtk::ListItem> &list_item) {
@@ -787,6 +1097,13 @@ public:
         if (!mitem) {
             return;
         }
+        if (mitem->get_widget_loaded(column)) {
+            // The button may already be bound to another cell.
+            auto it = bound_cells.find(mitem->get_widget(column));
+            if (it != bound_cells.end() && it->second.first == mitem) {
+                bound_cells.erase(it);
+            }
+        }
         mitem->set_widget_loaded(column, false);
     }
 
@@ -821,6 +1138,11 @@ public:
         if (mitem->is_selected()) {
             button->add_css_class("selected");
         }
+        if (mitem->state.is_gate_constraint_satisfied()) {
+            button->add_css_class("gate_satisfied");
+        } else if (mitem->state.is_gate_constraint_unsatisfied()) {
+            button->add_css_class("gate_unsatisfied");
+        }
         mitem->loaded = true;
         mitem->button = button;
     }
@@ -831,104 +1153,413 @@ public:
         if (!mitem) {
             return;
         }
+        if (mitem->loaded) {
+            mitem->button->remove_css_class("selected");
+            mitem->button->remove_css_class("gate_satisfied");
+            mitem->button->remove_css_class("gate_unsatisfied");
+        }
         mitem->loaded = false;
     }
 
-    void on_table_file_open_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
-                                            std::shared_ptr<Gio::AsyncResult> &res) {
-        auto result = file_dialog->open_finish(res);
-        auto stream = result->read();
-        auto file_info = result->query_info();
-        auto file_size = file_info->get_size();
-
-        using boost::spirit::qi::phrase_parse;
-        // 200 should be enough for the first row
-        const std::size_t first_line_size = file_size < 200 ? file_size : 200;
-        char* buffer = new char[first_line_size + 1];
-
-        std::string first_line = read_line_from_gstream(stream, first_line_size, file_size, buffer);
-        if (first_line.empty()) {
-            std::cerr << "Failed to read the header line." << std::endl;
-            delete[] buffer;
+    // Reads and parses a whole table file, returns nullptr on failure.
+    // The file is read as a stream, so it works for any Gio::File, while rows are parsed on the other cores.
+    // gzip and zstd compressed files are decompressed on the way.
+    std::shared_ptr<table_store<BlueprintFieldType>> read_table_file(const Glib::RefPtr<Gio::File> &file) {
+        // One core reads, the rest parse.
+        const std::size_t threads_amount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        pipelined_table_reader<BlueprintFieldType> reader(threads_amount);
+        std::shared_ptr<table_store<BlueprintFieldType>> new_store;
+        try {
+            auto stream = file->read();
+            auto read_stream = [&stream](char* data, std::size_t size) {
+                return std::size_t(stream->read(data, size));
+            };
+            decompressing_reader<decltype(read_stream)> input(read_stream, threads_amount);
+            new_store = reader.read([&input](char* data, std::size_t size) { return input(data, size); });
+            stream->close();
+        } catch (const Glib::Error &e) {
+            std::cerr << "Failed to read the file: " << e.what() << std::endl;
+            return nullptr;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return nullptr;
+        }
+        std::cout << "Successfully parsed the file" << std::endl;
+        std::cout << "Table store: " << new_store->get_allocated_blocks_amount() << " of "
+                  << new_store->get_blocks_amount() << " blocks hold non-zero values, "
+                  << new_store->get_memory_size() / (1024 * 1024) << " MiB" << std::endl;
+        return new_store;
+    }
+
+    // Only scans the file, rows are read as they are accessed, see text_page_source.
+    // Without a memory limit all the pages stay in memory once read, and the source is returned in lazy_source
+    // so that the rest of the pages can be parsed in the background.
+    std::shared_ptr<table_store<BlueprintFieldType>> open_paged_table(
+            const std::string &path, std::shared_ptr<text_page_source<BlueprintFieldType>> &lazy_source) {
+        try {
+            auto source = std::make_shared<text_page_source<BlueprintFieldType>>(path);
+            auto new_store = std::make_shared<table_store<BlueprintFieldType>>(source->get_sizes());
+            auto selector_bitmaps = source->take_selector_bitmaps();
+            for (std::size_t i = 0; i < selector_bitmaps.size(); i++) {
+                new_store->set_selector_bitmap(i, std::move(selector_bitmaps[i]));
+            }
+            if (options.paged_memory <= 0) {
+                new_store->set_page_source(source, source->get_pages_amount());
+                std::cout << "Lazy table: " << source->get_pages_amount() << " pages of "
+                          << table_store<BlueprintFieldType>::block_rows << " rows, parsed as they are needed"
+                          << std::endl;
+                lazy_source = source;
+                return new_store;
+            }
+            const std::size_t max_pages =
+                std::max<std::size_t>(1, std::size_t(options.paged_memory) * 1024 * 1024 /
+                                             new_store->get_page_memory_size());
+            new_store->set_page_source(source, max_pages);
+            std::cout << "Paged table: " << source->get_pages_amount() << " pages of "
+                      << table_store<BlueprintFieldType>::block_rows << " rows, at most " << max_pages
+                      << " of them in memory" << std::endl;
+            return new_store;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    // Pages of a paged table are read ahead of the view in the direction it is scrolled in,
+    // when the main loop has nothing else to do.
+    void on_table_scrolled() {
+        auto adjustment = table_window.get_vadjustment();
+        const double value = adjustment->get_value();
+        const bool forward = value >= last_scroll_value;
+        last_scroll_value = value;
+        if (!store || !store->is_paged() || sizes.max_size == 0 || prefetch_pending) {
+            return;
+        }
+        const double item_size = (adjustment->get_upper() - adjustment->get_lower()) / sizes.max_size;
+        if (item_size <= 0) {
+            return;
+        }
+        const std::size_t page_rows = table_store<BlueprintFieldType>::block_rows;
+        const std::size_t first_page = std::size_t(value / item_size) / page_rows;
+        const std::size_t last_page = std::size_t((value + adjustment->get_page_size()) / item_size) / page_rows;
+        if (forward) {
+            prefetch_page = last_page + 1;
+        } else if (first_page != 0) {
+            prefetch_page = first_page - 1;
+        } else {
             return;
         }
+        prefetch_pending = true;
+        Glib::signal_idle().connect_once(sigc::mem_fun(*this, &ExcaliburWindow::on_prefetch_idle));
+    }
+
+    void on_prefetch_idle() {
+        prefetch_pending = false;
+        if (store) {
+            store->prefetch(prefetch_page);
+        }
+    }
 
-        table_sizes_parser<decltype(first_line.begin())> sizes_parser;
-        auto first_line_begin = first_line.begin();
+    void start_page_loader(const std::shared_ptr<text_page_source<BlueprintFieldType>> &source) {
+        // One core is left to the interface, which parses the rows it shows itself.
+        const std::size_t threads_amount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        page_loader = std::make_unique<background_page_loader<BlueprintFieldType>>(
+            source, threads_amount, 2 * threads_amount, [this]() { pages_loaded_dispatcher.emit(); });
+    }
 
-        bool r = phrase_parse(first_line_begin, first_line.end(), sizes_parser, boost::spirit::ascii::space, sizes);
-        if (!r || first_line_begin != first_line.end()) {
-            std::cerr << "Failed to parse the header line." << std::endl;
-            delete[] buffer;
+    // Runs on the main loop whenever the workers have parsed pages of a lazily read table.
+    void on_pages_loaded() {
+        if (!page_loader) {
             return;
         }
+        page_loader->take_ready_pages(
+            [this](std::size_t page, const std::vector<typename field_traits<BlueprintFieldType>::cell_type> &values) {
+                store->install_page(page, values);
+            });
+        if (!page_loader->is_finished()) {
+            return;
+        }
+        if (page_loader->has_failed()) {
+            std::cerr << "Failed to parse the table in the background, rows are parsed as they are viewed" << std::endl;
+        } else {
+            std::cout << "All rows of the table are parsed" << std::endl;
+        }
+        page_loader.reset();
+    }
 
-        delete[] buffer;
-
-        auto predicted_line_size = (file_size - first_line.size()) / sizes.max_size * 2;
-        buffer = new char[predicted_line_size + 1];
-        table_row_parser<decltype(first_line.begin()), BlueprintFieldType> row_parser(sizes);
+    void on_table_file_open_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
+                                            std::shared_ptr<Gio::AsyncResult> &res) {
+        open_table(file_dialog->open_finish(res));
+    }
+
+    void open_table(const Glib::RefPtr<Gio::File> &result) {
+        std::shared_ptr<table_store<BlueprintFieldType>> new_store;
+        std::shared_ptr<text_page_source<BlueprintFieldType>> lazy_source;
+        // Paging needs random access, which only uncompressed local files are guaranteed to have.
+        const bool random_access = !result->get_path().empty() &&
+                                   detect_file_compression(result->get_path()) == compression_format::none;
+        const bool partial = options.has_window() && !result->get_path().empty();
+        // Taken before the table is read, so that the watch notices changes made while it is read.
+        struct stat table_info = {};
+        if (options.watch_table && random_access) {
+            ::stat(result->get_path().c_str(), &table_info);
+        }
+        if (options.has_window() && !partial) {
+            std::cout << "The table is not local, it is read as a whole" << std::endl;
+        }
+        if ((options.paged_memory > 0 || options.lazy_parsing) && !random_access && !partial) {
+            std::cout << "The table is compressed or not local, it is read as a whole" << std::endl;
+        }
+        if (partial) {
+            new_store = read_table_window(result->get_path());
+        } else if ((options.paged_memory > 0 || options.lazy_parsing) && random_access) {
+            new_store = open_paged_table(result->get_path(), lazy_source);
+        } else {
+            new_store = read_table_file(result);
+        }
+        if (!new_store) {
+            return;
+        }
+        set_table(new_store);
+        table_path = result->get_path();
+        if (lazy_source) {
+            start_page_loader(lazy_source);
+        }
 
-        auto store = Gio::ListStore<row_object<BlueprintFieldType>>::create();
+        // The circuit is kept, only what depends on the table is rebuilt.
+        index_kept_circuit();
 
-        for (std::uint32_t i = 0; i < sizes.max_size; i++) {
-            std::string line = read_line_from_gstream(stream, predicted_line_size, file_size, buffer);
-            if (line.empty()) {
-                std::cerr << "Failed to read line " << i + 1 << " of the file" << std::endl;
-                delete[] buffer;
-                return;
+        if (options.watch_table) {
+            if (!random_access || store->is_paged() || !store->get_window().is_whole()) {
+                std::cout << "Only uncompressed local tables read as a whole are watched" << std::endl;
+            } else {
+                start_table_watch(table_info);
             }
+        }
+    }
 
-            auto line_begin = line.begin();
-            std::vector<integral_type> row;
-            row.push_back(i);
-            r = phrase_parse(line_begin, line.end(), row_parser, boost::spirit::ascii::space, row);
-            if (!r || line_begin != line.end()) {
-                std::cerr << "Failed to parse line " << i + 1 << " of the file" << std::endl;
-                delete[] buffer;
-                return;
+    // Reads the part of the table given in the options, the row index is kept next to the check results.
+    std::shared_ptr<table_store<BlueprintFieldType>> read_table_window(const std::string &path) {
+        const std::size_t threads_amount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        table_window_reader<BlueprintFieldType> reader(threads_amount, options.result_cache_dir);
+        try {
+            auto new_store = reader.read(path, options.window_first_row, options.window_rows_amount,
+                                         options.window_columns);
+            const table_window &window = new_store->get_window();
+            const std::size_t loaded_columns = window.columns.empty() ? new_store->get_columns_amount() :
+                std::count(window.columns.begin(), window.columns.end(), true);
+            std::cout << "Loaded rows " << window.first_row << ".."
+                      << window.first_row + new_store->get_rows_amount() - 1 << " and " << loaded_columns
+                      << " of " << new_store->get_columns_amount() << " columns"
+                      << (reader.was_index_reused() ? ", found through the kept row index" : "") << std::endl;
+            return new_store;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    void open_shared_table(const std::string &name) {
+        std::shared_ptr<table_store<BlueprintFieldType>> new_store;
+        try {
+            auto source = std::make_shared<shared_page_source<BlueprintFieldType>>(name);
+            new_store = std::make_shared<table_store<BlueprintFieldType>>(source->get_sizes());
+            auto selector_bitmaps = source->get_selector_bitmaps();
+            for (std::size_t i = 0; i < selector_bitmaps.size(); i++) {
+                new_store->set_selector_bitmap(i, std::move(selector_bitmaps[i]));
             }
+            // Pages are only evicted if the memory is bounded, otherwise every row block stays once it was read.
+            const std::size_t max_pages = options.paged_memory <= 0 ? source->get_pages_amount() :
+                std::max<std::size_t>(1, std::size_t(options.paged_memory) * 1024 * 1024 /
+                                             new_store->get_page_memory_size());
+            new_store->set_page_source(source, max_pages);
+            std::cout << "Shared table " << name << ": " << source->get_pages_amount() << " pages of "
+                      << table_store<BlueprintFieldType>::block_rows << " rows, read from the segment as they are "
+                      << "needed" << std::endl;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+        set_table(new_store);
+        table_path.clear();
+        index_kept_circuit();
+    }
 
-            store->append(row_object<BlueprintFieldType>::create(row, i));
+    // Indexes the circuit against a newly opened table. A circuit referring to selectors or columns
+    // the table does not have is closed instead, as nothing compiled from it could be evaluated.
+    void index_kept_circuit() {
+        if (circuit.gates.empty() && circuit.copy_constraints.empty()) {
+            return;
         }
-        std::cout << "Successfully parsed the file" << std::endl;
-        delete[] buffer;
-        stream->close();
+        try {
+            validate_circuit(circuit, sizes);
+        } catch (const std::runtime_error &e) {
+            std::cerr << "The circuit does not fit the new table and was closed: " << e.what() << std::endl;
+            clear_circuit();
+            circuit = circuit_container<BlueprintFieldType>();
+            circuit_path.clear();
+            circuit_hash = 0;
+            return;
+        }
+        index.build(*store, circuit);
+    }
 
-        std::size_t column_size = sizes.witnesses_size + sizes.public_inputs_size +
-                                  sizes.constants_size + sizes.selectors_size;
+    // Regenerating a table usually writes the file in several steps, so it is only read again
+    // once it did not change for a moment.
+    static constexpr unsigned int table_reload_delay_ms = 200;
+
+    void start_table_watch(const struct stat &table_info) {
+        try {
+            table_watch = std::make_unique<watched_table_file<BlueprintFieldType>>(table_path, table_info);
+            table_monitor = Gio::File::create_for_path(table_path)->monitor_file();
+        } catch (const Glib::Error &e) {
+            std::cerr << "Failed to watch the table file: " << e.what() << std::endl;
+            table_watch.reset();
+            return;
+        } catch (const std::runtime_error &e) {
+            std::cerr << "Failed to watch the table file: " << e.what() << std::endl;
+            return;
+        }
+        table_monitor->signal_changed().connect(sigc::mem_fun(*this, &ExcaliburWindow::on_table_file_changed));
+        if (table_watch->is_stale()) {
+            std::cout << "The table file changed while it was read, reading the changes" << std::endl;
+            reload_table();
+        }
+    }
+
+    void stop_table_watch() {
+        table_reload_timeout.disconnect();
+        if (table_monitor) {
+            table_monitor->cancel();
+            table_monitor.reset();
+        }
+        table_watch.reset();
+    }
+
+    void on_table_file_changed(const Glib::RefPtr<Gio::File>&, const Glib::RefPtr<Gio::File>&,
+                               Gio::FileMonitor::Event event) {
+        if (event == Gio::FileMonitor::Event::DELETED || event == Gio::FileMonitor::Event::ATTRIBUTE_CHANGED) {
+            return;
+        }
+        table_reload_timeout.disconnect();
+        table_reload_timeout = Glib::signal_timeout().connect(
+            sigc::mem_fun(*this, &ExcaliburWindow::on_table_reload_timeout), table_reload_delay_ms);
+    }
+
+    bool on_table_reload_timeout() {
+        reload_table();
+        return false;
+    }
+
+    // Patches the changed cells into the store and the view in place, so that the scroll position
+    // and the selection stay, and brings an up to date check result up to date again.
+    void reload_table() {
+        const bool check_valid = has_check_result && check_version == store->get_version();
+        table_reload_result reload;
+        try {
+            reload = table_watch->reload(*store);
+        } catch (const std::runtime_error &e) {
+            // Most likely the file is still being written, it is read again after the next change.
+            std::cerr << "Failed to reload the table: " << e.what() << std::endl;
+            return;
+        }
+        if (reload.resized) {
+            std::cout << "The sizes of the table changed, reading it as a whole" << std::endl;
+            open_table(Gio::File::create_for_path(table_path));
+            return;
+        }
+        if (reload.changed_blocks.empty()) {
+            return;
+        }
+        std::cout << "Reloaded " << reload.changed_blocks.size() << " changed row blocks, "
+                  << reload.cells.size() << " cells changed" << std::endl;
+        if (reload.cells.empty()) {
+            return;
+        }
 
-        auto get_column_name = [](const table_sizes &sizes, std::size_t i) {
-            if (i == 0) {
-                return std::string("Row");
+        // Changed cells are marked the way differences from another table are, the earlier marks go.
+        clear_diff();
+        auto model = table_view.get_model();
+        bool selectors_changed = false;
+        const std::size_t selectors_start = sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size;
+        for (const cell_position &position : reload.cells) {
+            selectors_changed = selectors_changed || position.column >= selectors_start;
+            auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(position.row));
+            if (!row) {
+                continue;
             }
-            std::stringstream ss;
-            auto fixed_width_size = [&ss](std::size_t j) {
-                ss << std::setfill('0') << std::setw(4) << j;
-                return ss.str();
-            };
+            row->forget_string(position.column + 1);
+            if (row->get_widget_loaded(position.column + 1)) {
+                auto label = dynamic_cast<Gtk::Label*>(row->get_widget(position.column + 1)->get_child());
+                if (label) {
+                    label->set_text(row->to_string(position.column + 1));
+                }
+            }
+            row->get_cell_state(position.column + 1).mark_different();
+            queue_cell_style(row, position.column + 1);
+        }
+        diff_cells = std::move(reload.cells);
+
+        // Gates are enabled by the selectors, the rest of the index does not depend on the values.
+        if (selectors_changed && (!circuit.gates.empty() || !circuit.copy_constraints.empty())) {
+            index.build(*store, circuit);
+        }
 
-            if (i < sizes.witnesses_size + 1) {
-                return "W" + fixed_width_size(i - 1);
-            } else if (i < sizes.witnesses_size + sizes.public_inputs_size + 1) {
-                return "P" + fixed_width_size(i - sizes.witnesses_size - 1);
-            } else if (i < sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + 1) {
-                return "C" + fixed_width_size(i - sizes.witnesses_size - sizes.public_inputs_size - 1);
+        if (check_valid) {
+            std::vector<bool> changed(store->get_row_blocks_amount(), false);
+            if (check_blocks.size() == changed.size()) {
+                for (std::size_t block : reload.changed_blocks) {
+                    changed[block] = true;
+                }
             } else {
-                return "S" + fixed_width_size(i - sizes.witnesses_size - sizes.public_inputs_size
-                                                - sizes.constants_size - 1);
+                // Results per row block are not known for checks taken from a session.
+                changed.assign(changed.size(), true);
+                check_blocks.assign(changed.size(), cached_row_block());
             }
+            std::size_t rechecked_blocks = 0;
+            check_result = recheck_row_blocks(evaluator, *store, changed, check_blocks, check_result.failures,
+                                              rechecked_blocks);
+            check_version = store->get_version();
+            std::cout << "Checked the gates of " << rechecked_blocks << " of " << changed.size()
+                      << " row blocks again" << std::endl;
+            show_check_result();
+        } else if (selected_constraint.tracked_object != nullptr) {
+            clear_highlights();
+            highlight_constraint(selected_constraint.tracked_object);
+        }
+    }
+
+    // Replaces the table and rebuilds the view of it, the constraint index is left to the caller.
+    void set_table(const std::shared_ptr<table_store<BlueprintFieldType>> &new_store) {
+        // Pages still being parsed belong to the old table.
+        page_loader.reset();
+        stop_table_watch();
+        sizes = new_store->get_sizes();
+        store = new_store;
+        has_check_result = false;
+        rows_model = row_model<BlueprintFieldType>::create(store);
+
+        std::size_t column_size = sizes.witnesses_size + sizes.public_inputs_size +
+                                  sizes.constants_size + sizes.selectors_size;
 
-        };
         // Carefully remove the already existing columns
         while (table_view.get_columns()->get_n_items() != 0) {
             auto current_columns = table_view.get_columns();
             table_view.remove_column(
                 std::dynamic_pointer_cast<Gtk::ColumnViewColumn>(current_columns->get_object(0)));
         }
-        // Clear selections as they are no longer relevant
+        // Clear selections, search and diff results as they are no longer relevant
+        clear_diff();
+        clear_graph();
+        search.clear();
+        search_results.clear();
+        search_label.set_text("");
+        clear_highlights();
         selected_cell.clear();
         selected_constraint.clear();
+        // Rows of the old model are going away with it.
+        pending_style_cells.clear();
+        bound_cells.clear();
         // Clear constraint view
         auto constraint_store = Gio::ListStore<constraint_object<BlueprintFieldType>>::create();
         setup_constraint_view_from_store(constraint_store);
@@ -944,119 +1575,121 @@ public:
 
             auto column = Gtk::ColumnViewColumn::create(get_column_name(sizes, i), factory);
             column->set_resizable(true);
+            column->set_visible(i == 0 || store->get_window().is_column_loaded(i - 1));
             table_view.append_column(column);
         }
 
-        auto model = Gtk::NoSelection::create(store);
+        auto model = Gtk::NoSelection::create(rows_model);
         table_view.set_model(model);
     }
 
-    void on_circuit_file_open_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
-                                              std::shared_ptr<Gio::AsyncResult> &res) {
-
-        auto result = file_dialog->open_finish(res);
-        if (table_view.get_columns()->get_n_items() == 0) {
-            std::cerr << "Please open the table before opening the circuit!" << std::endl;
-            return;
+    // Name of the view column, column 0 is the row number.
+    static std::string get_column_name(const table_sizes &sizes, std::size_t i) {
+        if (i == 0) {
+            return std::string("Row");
         }
-        auto stream = result->read();
-        auto file_info = result->query_info();
-        auto file_size = file_info->get_size();
+        std::stringstream ss;
+        auto fixed_width_size = [&ss](std::size_t j) {
+            ss << std::setfill('0') << std::setw(4) << j;
+            return ss.str();
+        };
 
-        using boost::spirit::qi::phrase_parse;
-        // 200 should be enough for the first row
-        const std::size_t first_line_size = file_size < 200 ? file_size : 200;
-        char* buffer = new char[first_line_size + 1];
+        if (i < sizes.witnesses_size + 1) {
+            return "W" + fixed_width_size(i - 1);
+        } else if (i < sizes.witnesses_size + sizes.public_inputs_size + 1) {
+            return "P" + fixed_width_size(i - sizes.witnesses_size - 1);
+        } else if (i < sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + 1) {
+            return "C" + fixed_width_size(i - sizes.witnesses_size - sizes.public_inputs_size - 1);
+        } else {
+            return "S" + fixed_width_size(i - sizes.witnesses_size - sizes.public_inputs_size
+                                            - sizes.constants_size - 1);
+        }
+    }
 
-        std::string first_line = read_line_from_gstream(stream, first_line_size, file_size, buffer);
-        if (first_line.empty()) {
-            std::cerr << "Failed to read the header line." << std::endl;
-            delete[] buffer;
+    void on_table_diff_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
+                                       std::shared_ptr<Gio::AsyncResult> &res) {
+        auto result = file_dialog->open_finish(res);
+        auto other_store = read_table_file(result);
+        if (!other_store) {
             return;
         }
-
-        circuit_sizes_parser<decltype(first_line.begin())> sizes_parser;
-        auto first_line_begin = first_line.begin();
-
-        bool r = phrase_parse(first_line_begin, first_line.end(), sizes_parser, boost::spirit::ascii::space,
-                              circuit.sizes);
-        if (!r || first_line_begin != first_line.end()) {
-            std::cerr << "Failed to parse the header line." << std::endl;
-            delete[] buffer;
+        if (!same_table_sizes(other_store->get_sizes(), sizes)) {
+            std::cerr << "Only tables of the same sizes can be compared" << std::endl;
             return;
         }
-
-        delete[] buffer;
-
-        auto predicted_line_size = (file_size - first_line.size()) / circuit.sizes.gates_size;
-        buffer = new char[predicted_line_size + 1];
-        circuit.gates.reserve(circuit.sizes.gates_size);
-        for (std::uint32_t i = 0; i < circuit.sizes.gates_size; i++) {
-            std::string line = read_line_from_gstream(stream, predicted_line_size, file_size, buffer);
-            if (line.empty()) {
-                std::cerr << "Failed to header line for " << i + 1 << "'th gate of the file" << std::endl;
-                delete[] buffer;
-                return;
-            }
-            gate_header gate_header;
-            auto line_begin = line.begin();
-            gate_header_parser<decltype(line.begin())> header_parser;
-            r = phrase_parse(line_begin, line.end(), header_parser, boost::spirit::ascii::space, gate_header);
-            if (!r || line_begin != line.end()) {
-                std::cerr << "Failed to parse gate header for " << i + 1 << "'th gate of the file" << std::endl;
-                delete[] buffer;
-                return;
-            }
-            std::vector<plonk_constraint_type> constraints;
-            constraints.reserve(gate_header.constraints_size);
-            gate_constraint_parser<decltype(line.begin()), BlueprintFieldType> constraint_parser;
-            for (std::size_t j = 0; j < gate_header.constraints_size; j++) {
-                plonk_constraint_type constraint;
-                line = read_line_from_gstream(stream, predicted_line_size, file_size, buffer);
-                if (line.empty()) {
-                    std::cerr << "Failed to read line for" << j << "'th constraint for" << i << "'th gate of the file"
-                              << std::endl;
-                    delete[] buffer;
-                    return;
-                }
-                line_begin = line.begin();
-                r = phrase_parse(line_begin, line.end(), constraint_parser, boost::spirit::ascii::space, constraint);
-                if (!r || line_begin != line.end()) {
-                    std::cerr << "Failed to parse gate constraint " << j + 1 << " for " << i + 1
-                              << "'th gate of the file" << std::endl;
-                    delete[] buffer;
-                    return;
-                }
-                constraints.push_back(constraint);
+        clear_diff();
+        // Highlighting and navigating through more differences than this is not realistic.
+        const std::size_t max_diff_cells = 1 << 20;
+        auto diff = compare_tables(*store, *other_store, max_diff_cells);
+        std::cout << diff.identical_row_blocks << " of " << diff.row_blocks_amount
+                  << " row blocks are identical, " << diff.cells.size() << (diff.truncated ? "+" : "")
+                  << " cells differ" << std::endl;
+
+        auto model = table_view.get_model();
+        for (const cell_position &position : diff.cells) {
+            auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(position.row));
+            if (!row) {
+                continue;
             }
-
-            circuit.gates.emplace_back(plonk_gate_type(gate_header.selector_index, constraints));
+            row->get_cell_state(position.column + 1).mark_different();
+            queue_cell_style(row, position.column + 1);
+        }
+        diff_store = other_store;
+        diff_cells = std::move(diff.cells);
+
+        // Differences are navigated with the search buttons.
+        search_results = diff_cells;
+        search_position = 0;
+        if (search_results.empty()) {
+            search_label.set_text("Tables are equal");
+            return;
         }
-        std::sort(circuit.gates.begin(), circuit.gates.end(),
-                  [](const plonk_gate_type& a, const plonk_gate_type& b)
-                    { return a.selector_index < b.selector_index; });
+        show_search_result();
+    }
 
-        copy_constraint_parser<decltype(first_line.begin()), BlueprintFieldType> copy_constraint_parser;
-        circuit.copy_constraints.reserve(circuit.sizes.copy_constraints_size);
-        for (std::size_t i = 0; i < circuit.sizes.copy_constraints_size; i++) {
-            plonk_copy_constraint_type constraint;
-            std::string line = read_line_from_gstream(stream, predicted_line_size, file_size, buffer);
-            if (line.empty()) {
-                std::cerr << "Failed to read line for" << i << "'th copy constraint" << std::endl;
-                delete[] buffer;
-                return;
-            }
-            auto line_begin = line.begin();
-            r = phrase_parse(line_begin, line.end(), copy_constraint_parser, boost::spirit::ascii::space, constraint);
-            if (!r || line_begin != line.end()) {
-                std::cerr << "Failed to parse copy constraint " << i + 1 << std::endl;
-                delete[] buffer;
-                return;
+    void clear_diff() {
+        auto model = table_view.get_model();
+        for (const cell_position &position : diff_cells) {
+            auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(position.row));
+            if (!row) {
+                continue;
             }
-            circuit.copy_constraints.push_back(constraint);
+            row->get_cell_state(position.column + 1).unmark_different();
+            queue_cell_style(row, position.column + 1);
         }
+        diff_cells.clear();
+        diff_store.reset();
+    }
 
-        delete[] buffer;
+    // Parses a circuit file, which may be compressed, into circuit_out.
+    // Throws on read errors, corrupted compressed input and broken circuits.
+    void read_circuit_file(const Glib::RefPtr<Gio::File> &file, circuit_container<BlueprintFieldType> &circuit_out) {
+        auto stream = file->read();
+        auto read_stream = [&stream](char* data, std::size_t size) { return std::size_t(stream->read(data, size)); };
+        decompressing_reader<decltype(read_stream)> input(read_stream);
+        read_circuit([&input](char* data, std::size_t size) { return input(data, size); }, circuit_out);
+    }
+
+    void on_circuit_file_open_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
+                                              std::shared_ptr<Gio::AsyncResult> &res) {
+
+        auto result = file_dialog->open_finish(res);
+        if (table_view.get_columns()->get_n_items() == 0) {
+            std::cerr << "Please open the table before opening the circuit!" << std::endl;
+            return;
+        }
+        // The file is parsed into a separate container, the current circuit stays intact if parsing fails.
+        circuit_container<BlueprintFieldType> new_circuit;
+        try {
+            read_circuit_file(result, new_circuit);
+            validate_circuit(new_circuit, sizes);
+        } catch (const Glib::Error &e) {
+            std::cerr << "Failed to read the file: " << e.what() << std::endl;
+            return;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
 
         // Constraint cache building
         auto selection_model = dynamic_cast<Gtk::NoSelection*>(&*table_view.get_model());
@@ -1064,49 +1697,56 @@ public:
             std::cerr << "Failed to get selection model" << std::endl;
             return;
         }
-        auto model = selection_model->get_model();
-        for (std::size_t i = 0; i < circuit.sizes.copy_constraints_size; i++) {
-            auto constraint = &circuit.copy_constraints[i];
-            std::array<var, 2> variables = {constraint->first, constraint->second};
-            for (auto &variable : variables) {
-                auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(variable.rotation));
-                row->add_copy_constraint_to_cache(variable, i, constraint, sizes);
+
+        clear_circuit();
+        circuit = std::move(new_circuit);
+        circuit_path = result->get_path();
+
+        index.build(*store, circuit);
+        dag.build(circuit);
+        evaluator.build(dag, circuit);
+        circuit_hash = get_circuit_hash(circuit, dag);
+        print_circuit_stats();
+    }
+
+    // Everything referring to the circuit goes first: listed constraints point into it,
+    // and the DAG has to release the arena before the circuit drops it.
+    void clear_circuit() {
+        clear_highlights();
+        selected_constraint.clear();
+        setup_constraint_view_from_store(Gio::ListStore<constraint_object<BlueprintFieldType>>::create());
+        index.clear();
+        evaluator.clear();
+        dag.clear();
+        clear_graph();
+        has_check_result = false;
+    }
+
+    void print_circuit_stats() {
+        auto with_separators = [](std::size_t n) {
+            std::string digits = std::to_string(n);
+            for (int i = int(digits.size()) - 3; i > 0; i -= 3) {
+                digits.insert(i, ",");
             }
+            return digits;
+        };
+        for (std::size_t i = 0; i < circuit.gates.size(); i++) {
+            std::size_t selector = circuit.gates[i].selector_index;
+            std::cout << "Gate " << i << ": selector " << selector << " active on "
+                      << with_separators(store->get_selector_rows_amount(selector)) << " rows" << std::endl;
         }
-        // Gate cache building
-        for (std::size_t i = 0; i < circuit.sizes.gates_size; i++) {
-            auto gate = &circuit.gates[i];
-            for (std::size_t j = 0; j < gate->constraints.size(); j++) {
-                std::set<var> variable_set;
-                std::function<void(var)> variable_extractor =
-                    [&variable_set](var variable) { variable_set.insert(variable); };
-                nil::crypto3::math::expression_for_each_variable_visitor<var> visitor(variable_extractor);
-                visitor.visit(gate->constraints[j]);
-
-                row_object<BlueprintFieldType> *previous_row = nullptr, *current_row = nullptr, *next_row = nullptr;
-                current_row = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(0));
-                next_row = (sizes.max_size > 1) ?
-                    dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(1))
-                    : nullptr;
-                for (std::size_t k = 0; k < sizes.max_size;
-                     k++, previous_row = current_row, current_row = next_row,
-                        next_row = (k + 1 < sizes.max_size) ?
-                            dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(k + 1))
-                            : nullptr) {
-                    if (!current_row->selector_enabled(gate->selector_index, sizes)) {
-                        continue;
-                    }
-                    auto current_row_idx = current_row->get_row_index();
-                    for (auto &variable : variable_set) {
-                        current_row->add_constraint_to_cache(previous_row, next_row, variable,
-                                                             i, j, current_row_idx, &gate->constraints[j], sizes);
-                    }
-                    var selector = var(gate->selector_index, 0, false, var::column_type::selector);
-                    current_row->add_constraint_to_cache(nullptr, nullptr, selector,
-                                                         i, j, current_row_idx, &gate->constraints[j], sizes);
-                }
-            }
+        std::size_t tree_nodes = dag.get_tree_nodes_size();
+        // Nothing is known about the trees of a DAG taken from a session snapshot.
+        if (tree_nodes == 0) {
+            std::cout << "Expression DAG: " << with_separators(dag.get_nodes_size()) << " nodes, "
+                      << with_separators(dag.get_memory_size() / 1024) << " KiB" << std::endl;
+            return;
         }
+        std::cout << "Expression DAG: " << with_separators(dag.get_nodes_size()) << " nodes instead of "
+                  << with_separators(tree_nodes) << ", "
+                  << with_separators(dag.get_memory_size() / 1024) << " KiB instead of "
+                  << with_separators(dag.get_tree_memory_size() / 1024) << " KiB"
+                  << " (" << (100 * (tree_nodes - dag.get_nodes_size()) / tree_nodes) << "% shared)" << std::endl;
     }
 
     void on_table_file_save_dialog_response(Glib::RefPtr<Gtk::FileDialog> file_dialog,
@@ -1128,48 +1768,36 @@ public:
                << " constants_size: " << sizes.constants_size << " selectors_size: " << sizes.selectors_size
                << " max_size: " << sizes.max_size << "\n";
         stream->write(header.str().c_str(), header.str().size());
-        auto model = dynamic_cast<Gtk::NoSelection*>(&*table_view.get_model());
-        if (!model) {
-            std::cerr << "No model" << std::endl;
-            stream->close();
-            return;
+        std::vector<typename table_store<BlueprintFieldType>::column_span> columns;
+        for (std::size_t j = 0; j < store->get_columns_amount(); j++) {
+            columns.push_back(store->get_column_span(j));
         }
-        auto list_model = model->get_model();
         std::uint32_t width = wide_export ? (BlueprintFieldType::modulus_bits + 4 - 1) / 4 : 0;
+        auto printable = [](const auto &cell) -> const auto& {
+            return field_traits<BlueprintFieldType>::printable(cell);
+        };
         for (std::size_t i = 0; i < sizes.max_size; i++) {
             std::stringstream row_stream;
             row_stream << std::hex << std::setfill('0');
-            auto object_row = model->get_object(i);
-            if (!object_row) {
-                std::cerr << "No object" << std::endl;
-                stream->close();
-                return;
-            }
-            auto row = dynamic_cast<row_object<BlueprintFieldType>*>(&*object_row);
-            if (!row) {
-                std::cerr << "No row" << std::endl;
-                stream->close();
-                return;
-            }
-            std::size_t curr_idx = 1;
+            std::size_t curr_idx = 0;
             for (std::size_t j = 0; j < sizes.witnesses_size; j++) {
-                row_stream << std::setw(width) << row->get_row_item(curr_idx++).data << " ";
+                row_stream << std::setw(width) << printable(columns[curr_idx++][i]) << " ";
             }
             row_stream << "| ";
             for (std::size_t j = 0; j < sizes.public_inputs_size; j++) {
-                row_stream << std::setw(width) << row->get_row_item(curr_idx++).data << " ";
+                row_stream << std::setw(width) << printable(columns[curr_idx++][i]) << " ";
             }
             row_stream << "| ";
             for (std::size_t j = 0; j < sizes.constants_size; j++) {
                 row_stream << std::setw(width)
-                           << row->get_row_item(curr_idx++).data
+                           << printable(columns[curr_idx++][i])
                            << " ";
             }
             row_stream << "| ";
             for (std::size_t j = 0; j < sizes.selectors_size - 1; j++) {
-                row_stream << row->get_row_item(curr_idx++).data << " ";
+                row_stream << printable(columns[curr_idx++][i]) << " ";
             }
-            row_stream << row->get_row_item(curr_idx).data << "\n";
+            row_stream << printable(columns[curr_idx][i]) << "\n";
             stream->write(row_stream.str().c_str(), row_stream.str().size());
         }
         stream->close();
@@ -1181,10 +1809,14 @@ public:
         if (!mitem) {
             return;
         }
-        std::size_t row = mitem->get_row_index();
-        auto button = dynamic_cast<Gtk::Button*>(&*list_item->get_child());
+        select_cell(mitem, column);
+    }
 
-        if ((selected_cell.row == row && selected_cell.column == column) || button == nullptr) {
+    // Selects the cell and lists the constraints it takes part in. The cell does not have to be on screen.
+    // The dependency graph is started anew from the cell unless reset_graph is false.
+    void select_cell(row_object<BlueprintFieldType>* mitem, std::size_t column, bool reset_graph = true) {
+        std::size_t row = mitem->get_row_index();
+        if (selected_cell.row == row && selected_cell.column == column) {
             return;
         }
 
@@ -1192,19 +1824,16 @@ public:
             auto old_row = selected_cell.tracked_object;
             CellState& old_row_state = old_row->get_cell_state(selected_cell.column);
             old_row_state.deselect();
-            if (old_row->get_widget_loaded(selected_cell.column)) {
-                auto button = old_row->get_widget(selected_cell.column);
-                button->remove_css_class("selected");
-            }
+            queue_cell_style(old_row, selected_cell.column);
         }
 
         selected_cell.row = row;
         selected_cell.column = column;
         selected_cell.tracked_object = mitem;
 
-        button->add_css_class("selected");
         CellState &row_state = mitem->get_cell_state(column);
         row_state.select();
+        queue_cell_style(mitem, column);
 
         element_entry.set_text(mitem->to_string(column));
 
@@ -1215,17 +1844,243 @@ public:
             selected_constraint.tracked_object = nullptr;
         }
 
-        auto store = Gio::ListStore<constraint_object<BlueprintFieldType>>::create();
-        for (std::size_t i = 0; i < mitem->get_copy_constraints_size(column); i++) {
-            auto copy_constraint = mitem->get_copy_constraint(column, i);
-            store->append(constraint_object<BlueprintFieldType>::create(copy_constraint.second));
+        auto constraints_store = Gio::ListStore<constraint_object<BlueprintFieldType>>::create();
+        for (const auto &entry : index.get_copy_constraints(row, column - 1)) {
+            constraints_store->append(constraint_object<BlueprintFieldType>::create(
+                &circuit.copy_constraints[entry.constraint_num]));
+        }
+        // A cell is usually constrained by several constraints of the same gate at the same row,
+        // each such gate is evaluated once for all of them.
+        std::map<std::pair<std::size_t, std::size_t>,
+                 std::vector<typename gate_evaluator<BlueprintFieldType>::cell_type>> gate_results;
+        typename gate_evaluator<BlueprintFieldType>::context evaluation_context;
+        for (const auto &entry : index.get_gate_constraints(row, column - 1)) {
+            auto item = constraint_object<BlueprintFieldType>::create(
+                &circuit.gates[entry.gate].constraints[entry.constraint_num],
+                entry.row, entry.gate, entry.constraint_num);
+            auto key = std::make_pair(std::size_t(entry.row), std::size_t(entry.gate));
+            auto it = gate_results.find(key);
+            if (it == gate_results.end() && evaluator.fits(*store, entry.gate, entry.row)) {
+                evaluator.evaluate(*store, entry.gate, entry.row, evaluation_context);
+                it = gate_results.emplace(key, evaluation_context.results).first;
+            }
+            if (it != gate_results.end()) {
+                if (field_traits<BlueprintFieldType>::is_zero(it->second[entry.constraint_num])) {
+                    item->state.gate_constraint_satisfied();
+                } else {
+                    item->state.gate_constraint_unsatisfied();
+                }
+            }
+            constraints_store->append(item);
+        }
+        setup_constraint_view_from_store(constraints_store);
+
+        if (reset_graph) {
+            graph.reset(row, column - 1);
+            graph_offset_x = graph_offset_y = 0;
+            expand_graph(0);
+        }
+    }
+
+    void expand_graph(std::size_t node) {
+        if (evaluator.get_gates_amount() == 0 && circuit.copy_constraints.empty()) {
+            graph_label.set_text("Open a circuit to see the dependencies");
+            graph_area.queue_draw();
+            return;
+        }
+        std::size_t added = graph.expand(*store, circuit, index, evaluator, node,
+                                         graph_hops_button.get_value_as_int());
+        std::string label = std::to_string(graph.get_nodes().size()) + " nodes";
+        if (graph.get_nodes().size() >= graph.get_node_budget()) {
+            label += ", node budget reached";
+        } else if (added == 0) {
+            label += ", nothing to add";
+        }
+        graph_label.set_text(label);
+        if (graph_tick_id == 0) {
+            graph_tick_id = graph_area.add_tick_callback(sigc::mem_fun(*this, &ExcaliburWindow::on_graph_tick));
+        }
+    }
+
+    // Layout runs a step per frame while the nodes are still moving.
+    bool on_graph_tick(const Glib::RefPtr<Gdk::FrameClock>&) {
+        bool moving = graph.layout_step();
+        graph_area.queue_draw();
+        if (!moving) {
+            graph_tick_id = 0;
+        }
+        return moving;
+    }
+
+    void clear_graph() {
+        graph.clear();
+        graph_label.set_text("");
+        graph_area.queue_draw();
+    }
+
+    void on_graph_pressed(int n_press, double x, double y) {
+        const double width = graph_area.get_width(), height = graph_area.get_height();
+        std::size_t node = graph.find_node_at((x - width / 2 - graph_offset_x) / graph_scale,
+                                              (y - height / 2 - graph_offset_y) / graph_scale,
+                                              graph_node_radius / graph_scale + graph_node_radius);
+        if (node == graph.get_nodes().size()) {
+            return;
+        }
+        const auto &current = graph.get_nodes()[node];
+        if (n_press == 2 && current.kind == dependency_graph<BlueprintFieldType>::node_kind::cell) {
+            auto model = table_view.get_model();
+            auto mitem = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(current.row));
+            if (!mitem) {
+                return;
+            }
+            select_cell(mitem, current.column + 1, false);
+            scroll_to_cell(current.row, current.column + 1);
+            return;
+        }
+        expand_graph(node);
+    }
+
+    void on_draw_graph(const Cairo::RefPtr<Cairo::Context> &cr, int width, int height) {
+        using graph_type = dependency_graph<BlueprintFieldType>;
+        const auto &nodes = graph.get_nodes();
+        cr->translate(width / 2.0 + graph_offset_x, height / 2.0 + graph_offset_y);
+        cr->scale(graph_scale, graph_scale);
+
+        cr->set_source_rgb(0.5, 0.5, 0.5);
+        cr->set_line_width(1);
+        for (const auto &edge : graph.get_edges()) {
+            cr->move_to(nodes[edge.from].x, nodes[edge.from].y);
+            cr->line_to(nodes[edge.to].x, nodes[edge.to].y);
+        }
+        cr->stroke();
+
+        // Labels are only readable on small graphs.
+        const bool draw_labels = nodes.size() <= 200 && graph_scale >= 0.5;
+        cr->set_font_size(10);
+        for (std::size_t i = 0; i < nodes.size(); i++) {
+            const auto &current = nodes[i];
+            switch (current.state) {
+                case graph_type::node_state::satisfied:
+                    cr->set_source_rgb(0.2, 0.8, 0.2);
+                    break;
+                case graph_type::node_state::unsatisfied:
+                    cr->set_source_rgb(0.86, 0.08, 0.24);
+                    break;
+                default:
+                    cr->set_source_rgb(0.0, 0.75, 1.0);
+                    break;
+            }
+            const double r = graph_node_radius;
+            switch (current.kind) {
+                case graph_type::node_kind::cell:
+                    cr->arc(current.x, current.y, r, 0, 2 * M_PI);
+                    break;
+                case graph_type::node_kind::gate:
+                    cr->rectangle(current.x - r, current.y - r, 2 * r, 2 * r);
+                    break;
+                case graph_type::node_kind::copy_constraint:
+                    cr->move_to(current.x, current.y - r);
+                    cr->line_to(current.x + r, current.y);
+                    cr->line_to(current.x, current.y + r);
+                    cr->line_to(current.x - r, current.y);
+                    cr->close_path();
+                    break;
+            }
+            cr->fill();
+            // Nodes with neighbours outside of the graph are outlined.
+            if (!current.expanded) {
+                cr->set_source_rgb(0.3, 0.3, 0.3);
+                cr->arc(current.x, current.y, r + 2, 0, 2 * M_PI);
+                cr->stroke();
+            }
+            if (draw_labels) {
+                std::string label;
+                switch (current.kind) {
+                    case graph_type::node_kind::cell:
+                        label = get_column_name(sizes, current.column + 1) + "[" +
+                                std::to_string(store->get_window().first_row + current.row) + "]";
+                        break;
+                    case graph_type::node_kind::gate:
+                        label = "G" + std::to_string(current.column) + "@" +
+                                std::to_string(store->get_window().first_row + current.row);
+                        break;
+                    case graph_type::node_kind::copy_constraint:
+                        label = "Copy " + std::to_string(current.row);
+                        break;
+                }
+                cr->set_source_rgb(0.9, 0.9, 0.9);
+                cr->move_to(current.x + graph_node_radius + 2, current.y + 4);
+                cr->show_text(label);
+            }
+        }
+    }
+
+    void on_search() {
+        if (!store) {
+            std::cerr << "Load a table first" << std::endl;
+            return;
+        }
+        search_query<BlueprintFieldType> query;
+        if (!parse_search_query<BlueprintFieldType>(search_entry.get_text(), sizes, query)) {
+            return;
+        }
+        // Columns which are not loaded would match every search for zero.
+        const table_window &window = store->get_window();
+        if (query.columns.empty() && !window.columns.empty()) {
+            for (std::size_t column = 0; column < window.columns.size(); column++) {
+                if (window.columns[column]) {
+                    query.columns.push_back(column);
+                }
+            }
+        }
+        // Navigating through more results than this is not realistic.
+        const std::size_t max_search_results = 1 << 20;
+        clear_diff();
+        search_results = search.find(*store, query, max_search_results);
+        search_position = 0;
+        if (search_results.empty()) {
+            search_label.set_text("Not found");
+            return;
+        }
+        show_search_result();
+    }
+
+    void on_search_step(int step) {
+        if (search_results.empty()) {
+            return;
         }
-        for (std::size_t i = 0; i < mitem->get_constraints_size(column); i++) {
-            auto constraint = mitem->get_constraint(column, i);
-            store->append(constraint_object<BlueprintFieldType>::create(
-                constraint.constraint, constraint.row, constraint.selector, constraint.constraint_num));
+        search_position = (search_position + search_results.size() + step) % search_results.size();
+        show_search_result();
+    }
+
+    void show_search_result() {
+        const cell_position &position = search_results[search_position];
+        std::string label = std::to_string(search_position + 1) + " / " + std::to_string(search_results.size());
+        if (diff_store) {
+            std::stringstream ss;
+            ss << std::hex << field_traits<BlueprintFieldType>::printable(
+                diff_store->get_cell(position.column, position.row));
+            label += ", other table: " + ss.str();
         }
-        setup_constraint_view_from_store(store);
+        search_label.set_text(label);
+        auto model = table_view.get_model();
+        auto mitem = dynamic_cast<row_object<BlueprintFieldType>*>(&*model->get_object(position.row));
+        if (!mitem) {
+            return;
+        }
+        select_cell(mitem, position.column + 1);
+        scroll_to_cell(position.row, position.column + 1);
+    }
+
+    // Rows and columns have fixed sizes, so the position is proportional to the index.
+    void scroll_to_cell(std::size_t row, std::size_t column) {
+        auto scroll = [](const Glib::RefPtr<Gtk::Adjustment> &adjustment, std::size_t index, std::size_t amount) {
+            double item_size = (adjustment->get_upper() - adjustment->get_lower()) / amount;
+            adjustment->set_value(adjustment->get_lower() +
+                                  std::max(0.0, index * item_size - adjustment->get_page_size() / 2));
+        };
+        scroll(table_window.get_vadjustment(), row, sizes.max_size);
+        scroll(table_window.get_hadjustment(), column, store->get_columns_amount() + 1);
     }
 
     void on_constraint_clicked(const Glib::RefPtr<Gtk::ListItem> &list_item) {
@@ -1310,15 +2165,67 @@ public:
 protected:
     Gtk::ColumnView table_view;
     Gtk::Entry element_entry;
-    Gtk::Box vbox_prime, vbox_controls;
+    Gtk::Box vbox_prime, vbox_controls, hbox_search;
     Gtk::ScrolledWindow table_window;
-    Gtk::Button open_table_button, open_circuit_button, save_table_button;
+    Gtk::Button open_table_button, open_circuit_button, save_table_button, diff_table_button, check_circuit_button;
+    Gtk::Button save_session_button, open_session_button;
+    Gtk::Entry search_entry;
+    Gtk::Button search_prev_button, search_next_button;
+    Gtk::Label search_label;
     Gtk::ListView constraints_view;
     Gtk::ScrolledWindow constraints_window;
+    Gtk::Notebook details_notebook;
+    Gtk::Box graph_box, hbox_graph;
+    Gtk::Label graph_hops_label, graph_label;
+    Gtk::SpinButton graph_hops_button;
+    Gtk::DrawingArea graph_area;
 private:
     table_sizes sizes;
+    std::shared_ptr<table_store<BlueprintFieldType>> store;
+    Glib::RefPtr<row_model<BlueprintFieldType>> rows_model;
     CellTracker<Gtk::Button, row_object<BlueprintFieldType>> selected_cell;
     CellTracker<Gtk::Button, constraint_object<BlueprintFieldType>> selected_constraint;
-    std::vector<CellTracker<Gtk::Button, row_object<BlueprintFieldType>>> highlighted_cells;
+    // Constraint highlights of rows with an older generation are stale.
+    std::uint32_t highlight_generation = 0;
+    // Cells whose buttons are currently bound, that is on screen or about to be.
+    std::unordered_map<Gtk::Button*, std::pair<row_object<BlueprintFieldType>*, std::size_t>> bound_cells;
+    std::vector<std::pair<Glib::RefPtr<row_object<BlueprintFieldType>>, std::size_t>> pending_style_cells;
+    bool restyle_bound_cells = false;
+    guint style_tick_id = 0;
+    viewer_options options;
+    double last_scroll_value = 0;
+    std::size_t prefetch_page = 0;
+    bool prefetch_pending = false;
+    // Declared before the loader, whose workers emit it, so that it outlives them.
+    Glib::Dispatcher pages_loaded_dispatcher;
+    std::unique_ptr<background_page_loader<BlueprintFieldType>> page_loader;
+    // Local files the table and the circuit were read from, empty if they were not local.
+    std::string table_path, circuit_path;
     circuit_container<BlueprintFieldType> circuit;
+    constraint_index<BlueprintFieldType> index;
+    expression_dag<BlueprintFieldType> dag;
+    gate_evaluator<BlueprintFieldType> evaluator;
+    // Key of the check results of the circuit in options.result_cache_dir.
+    std::uint64_t circuit_hash = 0;
+    // Result of the last check, valid while the store has the version it was checked at.
+    bool has_check_result = false;
+    std::uint64_t check_version = 0;
+    typename gate_evaluator<BlueprintFieldType>::check_result check_result;
+    // Results of the last check at the rows of every row block, empty if they are not known.
+    std::vector<cached_row_block> check_blocks;
+    // Set while the table file is watched.
+    std::unique_ptr<watched_table_file<BlueprintFieldType>> table_watch;
+    Glib::RefPtr<Gio::FileMonitor> table_monitor;
+    sigc::connection table_reload_timeout;
+    table_search<BlueprintFieldType> search;
+    std::vector<cell_position> search_results;
+    std::size_t search_position = 0;
+    // Table the current one was compared with, and the cells which differ.
+    std::shared_ptr<table_store<BlueprintFieldType>> diff_store;
+    std::vector<cell_position> diff_cells;
+    static constexpr double graph_node_radius = 6;
+    dependency_graph<BlueprintFieldType> graph;
+    double graph_offset_x = 0, graph_offset_y = 0, graph_drag_start_x = 0, graph_drag_start_y = 0;
+    double graph_scale = 1;
+    guint graph_tick_id = 0;
 };
@@ -0,0 +1,245 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include "diff.hpp"
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "pipeline.hpp"
+#include "search.hpp"
+#include "snapshot.hpp"
+#include "store.hpp"
+
+struct table_reload_result {
+    // The header of the file changed, nothing was written into the store and the table has to be opened again.
+    bool resized = false;
+    // Row blocks whose text changed, in order.
+    std::vector<std::size_t> changed_blocks;
+    // Cells whose values changed, sorted by row, then column. Blocks may change in text only, e.g. in spacing.
+    std::vector<cell_position> cells;
+};
+
+// Table file which is read again after it changes. The text of every row block is hashed, and only the blocks
+// whose hashes differ from the ones seen the last time are parsed and written into the store.
+template<typename BlueprintFieldType>
+class watched_table_file {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+    using store_type = table_store<BlueprintFieldType>;
+
+    static constexpr std::size_t block_rows = store_type::block_rows;
+
+    // loaded_info is the stat of the file taken before the store was read from it. If the file differs from it,
+    // the store may hold an older table than the hashes describe, so the first reload parses every block.
+    // Throws std::runtime_error if the file can not be read or its layout is broken.
+    watched_table_file(const std::string &path_, const struct stat &loaded_info) : path(path_), stale(true) {
+        struct stat info;
+        if (::stat(path.c_str(), &info) == 0) {
+            stale = info.st_size != loaded_info.st_size || get_mtime(info) != get_mtime(loaded_info);
+        }
+        scan(sizes, block_hashes, nullptr);
+    }
+
+    // Whether the file changed after the store was read and was not reloaded since.
+    bool is_stale() const {
+        return stale;
+    }
+
+    const std::string& get_path() const {
+        return path;
+    }
+
+    // Reads the file again and writes the changed cells into the store, which has to be of the sizes of the file.
+    // Throws std::runtime_error if the file can not be read or parsed, which is also what a file still being
+    // written looks like. The store is not modified then, and the next reload compares against the same blocks.
+    table_reload_result reload(store_type &store) {
+        table_reload_result result;
+        table_sizes new_sizes;
+        std::vector<std::uint64_t> new_hashes;
+        std::vector<std::pair<std::size_t, std::string>> texts;
+        scan(new_sizes, new_hashes, &texts);
+        // Sizes are kept, so that the file is reported as resized until the table is opened again.
+        if (!same_table_sizes(new_sizes, sizes)) {
+            result.resized = true;
+            return result;
+        }
+
+        // Everything is parsed before the store is touched, so that a broken row leaves it as it was.
+        std::vector<std::vector<cell_type>> values(texts.size());
+        const std::size_t threads_amount =
+            std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), texts.size()));
+        std::vector<std::exception_ptr> errors(threads_amount);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < threads_amount; t++) {
+            threads.emplace_back([&, t]() {
+                try {
+                    for (std::size_t i = t; i < texts.size(); i += threads_amount) {
+                        parse_block(texts[i].second, texts[i].first, values[i]);
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (const auto &error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        const std::size_t columns_amount = store.get_columns_amount();
+        for (std::size_t i = 0; i < texts.size(); i++) {
+            const std::size_t first_row = texts[i].first * block_rows;
+            const std::size_t rows = values[i].size() / columns_amount;
+            for (std::size_t row = first_row; row < first_row + rows; row++) {
+                for (std::size_t column = 0; column < columns_amount; column++) {
+                    const cell_type &value = values[i][(row - first_row) * columns_amount + column];
+                    if (!(store.get_cell(column, row) == value)) {
+                        store.set_cell(column, row, value);
+                        result.cells.push_back({std::uint32_t(row), std::uint32_t(column)});
+                    }
+                }
+            }
+            result.changed_blocks.push_back(texts[i].first);
+        }
+        block_hashes = std::move(new_hashes);
+        stale = false;
+        return result;
+    }
+
+private:
+    std::size_t get_columns_amount() const {
+        return sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + sizes.selectors_size;
+    }
+
+    // Hashes the rows of every row block. If texts is given and the header did not change, the text of every
+    // block whose hash differs from block_hashes, or of every block if the file is stale, is stored into it.
+    void scan(table_sizes &new_sizes, std::vector<std::uint64_t> &new_hashes,
+              std::vector<std::pair<std::size_t, std::string>>* texts) const {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        auto read_file = [file](char* data, std::size_t size) { return std::fread(data, 1, size, file); };
+        line_reader<decltype(read_file)> lines(read_file);
+        std::string line, block_text;
+        bool header_read = false, keep_texts = false;
+        std::size_t row = 0;
+        stable_hash block_hash;
+        try {
+            while (lines.next(line)) {
+                if (!header_read) {
+                    auto header_begin = line.begin();
+                    table_sizes_parser<std::string::iterator> sizes_parser;
+                    bool r = boost::spirit::qi::phrase_parse(header_begin, line.end(), sizes_parser,
+                                                             boost::spirit::ascii::space, new_sizes);
+                    if (!r || header_begin != line.end()) {
+                        throw std::runtime_error("Failed to parse the header line");
+                    }
+                    header_read = true;
+                    keep_texts = texts != nullptr && same_table_sizes(new_sizes, sizes);
+                    new_hashes.reserve((new_sizes.max_size + block_rows - 1) / block_rows);
+                    continue;
+                }
+                if (row >= new_sizes.max_size) {
+                    break;
+                }
+                line.push_back('\n');
+                block_hash.add(line.data(), line.size());
+                if (keep_texts) {
+                    block_text += line;
+                }
+                row++;
+                if (row % block_rows != 0 && row != new_sizes.max_size) {
+                    continue;
+                }
+                const std::size_t block = new_hashes.size();
+                new_hashes.push_back(block_hash.get());
+                block_hash = stable_hash();
+                if (keep_texts && (stale || new_hashes.back() != block_hashes[block])) {
+                    texts->emplace_back(block, std::move(block_text));
+                }
+                block_text.clear();
+            }
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+        const bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+        if (failed) {
+            throw std::runtime_error("Failed to read " + path);
+        }
+        if (!header_read || row < new_sizes.max_size) {
+            throw std::runtime_error("The table file is shorter than its header says");
+        }
+    }
+
+    void parse_block(const std::string &text, std::size_t block, std::vector<cell_type> &values) const {
+        const std::size_t columns_amount = get_columns_amount();
+        const std::size_t first_row = block * block_rows;
+        const std::size_t rows = std::min<std::size_t>(block_rows, sizes.max_size - first_row);
+        values.resize(rows * columns_amount);
+        table_row_parser<std::string::const_iterator, BlueprintFieldType> row_parser(sizes);
+        std::vector<typename traits::parsed_type> row;
+        auto line_begin = text.cbegin();
+        for (std::size_t i = 0; i < rows; i++) {
+            auto line_end = std::find(line_begin, text.cend(), '\n');
+            row.clear();
+            bool r = boost::spirit::qi::phrase_parse(line_begin, line_end, row_parser, boost::spirit::ascii::space,
+                                                     row);
+            if (!r || line_begin != line_end || row.size() < columns_amount) {
+                throw std::runtime_error("Failed to parse row " + std::to_string(first_row + i));
+            }
+            for (std::size_t column = 0; column < columns_amount; column++) {
+                values[i * columns_amount + column] = traits::from_parsed(row[column]);
+            }
+            line_begin = line_end == text.cend() ? line_end : line_end + 1;
+        }
+    }
+
+    std::string path;
+    table_sizes sizes;
+    // Stable hashes of the text of every row block of the file as it was read the last time.
+    std::vector<std::uint64_t> block_hashes;
+    bool stale;
+};
@@ -0,0 +1,487 @@
+// MIT License
+//
+// Copyright (c) 2023 Dmitrii Tabalin <d.tabalin@nil.foundation>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include "compression.hpp"
+#include "field_traits.hpp"
+#include "parsers.hpp"
+#include "pipeline.hpp"
+#include "search.hpp"
+#include "snapshot.hpp"
+#include "store.hpp"
+
+// Loading of a part of a table, a range of rows and some of the columns, for looking at a single component
+// of a table too large to be read as a whole. Uncompressed files are entered at the row block holding
+// the first row, found through an index of row offsets which is kept on disk between runs.
+// Only the values of the loaded columns are parsed, the other ones are skipped over as text.
+
+// Parses "first..last", both inclusive, or a single row. Returns false if the text is broken.
+inline bool parse_row_range(const std::string &text, std::size_t &first_row, std::size_t &rows_amount) {
+    auto parse_row = [](const std::string &str, std::size_t &row) {
+        const std::string trimmed = trim_spaces(str);
+        if (trimmed.empty() || !std::all_of(trimmed.begin(), trimmed.end(),
+                                            [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        try {
+            row = std::stoull(trimmed);
+        } catch (const std::exception &) {
+            return false;
+        }
+        return true;
+    };
+    const auto dots = text.find("..");
+    std::size_t last_row;
+    if (!parse_row(text.substr(0, dots), first_row)) {
+        return false;
+    }
+    if (dots == std::string::npos) {
+        last_row = first_row;
+    } else if (!parse_row(text.substr(dots + 2), last_row) || last_row < first_row) {
+        return false;
+    }
+    rows_amount = last_row - first_row + 1;
+    return true;
+}
+
+constexpr std::uint32_t row_offset_index_version = 1;
+constexpr char row_offset_index_magic[8] = {'E', 'X', 'C', 'R', 'O', 'W', 'S', '\0'};
+
+struct row_offset_index_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t step;
+    // Of the indexed file, the index is only used while they stay the same.
+    std::uint64_t file_size;
+    std::int64_t file_mtime;
+    std::uint64_t rows_amount;
+    std::uint64_t offsets_amount;
+    // Of the offsets.
+    std::uint64_t content_hash;
+};
+
+// Offsets of every step-th line after the header line of a text table file. Finding them only looks for newlines,
+// nothing is parsed. Indices are kept in a directory under the hash of the path of the file.
+class row_offset_index {
+public:
+    static constexpr std::size_t step = 1024;
+
+    row_offset_index() : rows_amount(0), reused(false) {}
+
+    // Takes the index kept in directory if it is there and up to date, otherwise scans the file and keeps
+    // the index there. Nothing is kept if directory is empty. Throws std::runtime_error if the file can not be read.
+    void open(const std::string &path, const std::string &directory) {
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        reused = false;
+        std::string index_path;
+        if (!directory.empty()) {
+            std::error_code error;
+            const std::string absolute_path = std::filesystem::absolute(path, error).string();
+            stable_hash path_hash;
+            path_hash.add(absolute_path.data(), absolute_path.size());
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.rows", static_cast<unsigned long long>(path_hash.get()));
+            index_path = (std::filesystem::path(directory) / name).string();
+            try {
+                if (std::filesystem::exists(index_path) && load(index_path, info)) {
+                    reused = true;
+                    return;
+                }
+            } catch (const std::exception &) {
+                // A broken index is built again.
+            }
+        }
+        scan(path);
+        if (!index_path.empty()) {
+            save(index_path, directory, info);
+        }
+    }
+
+    // Lines after the header line.
+    std::size_t get_rows_amount() const {
+        return rows_amount;
+    }
+
+    // Offset of the line of the row, rounded down to a multiple of step.
+    std::uint64_t get_offset(std::size_t row) const {
+        return offsets[row / step];
+    }
+
+    // Whether open took a kept index.
+    bool was_reused() const {
+        return reused;
+    }
+
+private:
+    void scan(const std::string &path) {
+        std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), std::fclose);
+        if (!file) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        offsets.clear();
+        rows_amount = 0;
+        const std::size_t chunk_size = 1 << 22;
+        std::vector<char> chunk(chunk_size);
+        std::uint64_t chunk_offset = 0;
+        bool header_read = false;
+        // Set while inside of a line which has not ended yet.
+        bool in_line = false;
+        std::size_t read;
+        while ((read = std::fread(chunk.data(), 1, chunk_size, file.get())) != 0) {
+            const char* begin = chunk.data();
+            const char* end = begin + read;
+            while (begin != end) {
+                if (!in_line && header_read) {
+                    if (rows_amount % step == 0) {
+                        offsets.push_back(chunk_offset + (begin - chunk.data()));
+                    }
+                    rows_amount++;
+                }
+                in_line = true;
+                const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+                if (newline == nullptr) {
+                    break;
+                }
+                header_read = true;
+                in_line = false;
+                begin = newline + 1;
+            }
+            chunk_offset += read;
+        }
+        if (std::ferror(file.get())) {
+            throw std::runtime_error("Failed to read " + path);
+        }
+    }
+
+    bool load(const std::string &index_path, const struct stat &info) {
+        mapped_file file(index_path);
+        row_offset_index_header header;
+        if (file.get_size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, file.get_data(), sizeof(header));
+        const bool usable =
+            std::equal(std::begin(row_offset_index_magic), std::end(row_offset_index_magic), header.magic) &&
+            header.version == row_offset_index_version && header.step == step &&
+            header.file_size == std::uint64_t(info.st_size) && header.file_mtime == get_mtime(info) &&
+            header.offsets_amount == (header.rows_amount + step - 1) / step &&
+            file.get_size() == sizeof(header) + header.offsets_amount * sizeof(std::uint64_t);
+        if (!usable) {
+            return false;
+        }
+        stable_hash content_hash;
+        content_hash.add(file.get_data() + sizeof(header), file.get_size() - sizeof(header));
+        if (content_hash.get() != header.content_hash) {
+            return false;
+        }
+        offsets.resize(header.offsets_amount);
+        std::memcpy(offsets.data(), file.get_data() + sizeof(header), offsets.size() * sizeof(std::uint64_t));
+        rows_amount = header.rows_amount;
+        return true;
+    }
+
+    // Failing to keep the index is not an error, it is built again next time.
+    void save(const std::string &index_path, const std::string &directory, const struct stat &info) const {
+        row_offset_index_header header = {};
+        std::copy(std::begin(row_offset_index_magic), std::end(row_offset_index_magic), header.magic);
+        header.version = row_offset_index_version;
+        header.step = step;
+        header.file_size = info.st_size;
+        header.file_mtime = get_mtime(info);
+        header.rows_amount = rows_amount;
+        header.offsets_amount = offsets.size();
+        stable_hash content_hash;
+        content_hash.add(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+        header.content_hash = content_hash.get();
+        // The file is replaced as a whole, so that a concurrent reader never sees it half written.
+        const std::string temp_path = index_path + ".tmp";
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+        bool written = file != nullptr &&
+                       std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       std::fwrite(offsets.data(), sizeof(std::uint64_t), offsets.size(), file) == offsets.size();
+        if (file != nullptr) {
+            written = std::fclose(file) == 0 && written;
+        }
+        if (!written || std::rename(temp_path.c_str(), index_path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            std::cerr << "Failed to keep the row index in " << index_path << std::endl;
+        }
+    }
+
+    std::vector<std::uint64_t> offsets;
+    std::size_t rows_amount;
+    bool reused;
+};
+
+// Reads a part of a table file into a store holding only that part, see table_window in store.hpp.
+// Row blocks of the part are parsed in parallel.
+template<typename BlueprintFieldType>
+class table_window_reader {
+public:
+    using traits = field_traits<BlueprintFieldType>;
+    using cell_type = typename traits::cell_type;
+    using parsed_type = typename traits::parsed_type;
+    using store_type = table_store<BlueprintFieldType>;
+
+    static constexpr std::size_t block_rows = store_type::block_rows;
+
+    // Row indices are kept in index_directory_, they are not kept if it is empty.
+    table_window_reader(std::size_t threads_amount_, const std::string &index_directory_ = std::string())
+        : threads_amount(std::max<std::size_t>(1, threads_amount_)), index_directory(index_directory_),
+          index_reused(false) {}
+
+    // Reads rows_amount rows from first_row on, up to the end of the table if rows_amount is 0 or reaches past it.
+    // columns are named as in the view, e.g. "W0..W9,P0", all of them are read if it is empty.
+    // Selectors are always read.
+    // Throws std::runtime_error if the file can not be read, is broken, or the part is not in the table.
+    std::shared_ptr<store_type> read(const std::string &path, std::size_t first_row, std::size_t rows_amount,
+                                     const std::string &columns) {
+        std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), std::fclose);
+        if (!file) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        auto read_file = [&file, &path](char* data, std::size_t size) {
+            const std::size_t read = std::fread(data, 1, size, file.get());
+            if (read == 0 && std::ferror(file.get())) {
+                throw std::runtime_error("Failed to read " + path);
+            }
+            return read;
+        };
+        index_reused = false;
+
+        // Compressed streams can not be entered in the middle, the rows before the part are skipped over.
+        if (detect_file_compression(path) != compression_format::none) {
+            decompressing_reader<decltype(read_file)> input(read_file, threads_amount);
+            auto read_input = [&input](char* data, std::size_t size) { return input(data, size); };
+            line_reader<decltype(read_input)> lines(read_input);
+            const table_sizes sizes = read_header(lines);
+            check_first_row(sizes, first_row);
+            for (std::size_t i = 0; i < first_row; i++) {
+                if (!lines.skip()) {
+                    throw std::runtime_error("The table file is shorter than its header says");
+                }
+            }
+            return read_rows(lines, sizes, first_row, rows_amount, columns);
+        }
+
+        table_sizes sizes;
+        {
+            line_reader<decltype(read_file)> lines(read_file, 1 << 16);
+            sizes = read_header(lines);
+        }
+        check_first_row(sizes, first_row);
+        row_offset_index index;
+        index.open(path, index_directory);
+        index_reused = index.was_reused();
+        if (first_row >= index.get_rows_amount()) {
+            throw std::runtime_error("The table file is shorter than its header says");
+        }
+        if (fseeko(file.get(), index.get_offset(first_row), SEEK_SET) != 0) {
+            throw std::runtime_error("Failed to read " + path);
+        }
+        line_reader<decltype(read_file)> lines(read_file);
+        for (std::size_t i = first_row / row_offset_index::step * row_offset_index::step; i < first_row; i++) {
+            lines.skip();
+        }
+        return read_rows(lines, sizes, first_row, rows_amount, columns);
+    }
+
+    // Whether the last read found the rows through an index kept from an earlier run.
+    bool was_index_reused() const {
+        return index_reused;
+    }
+
+private:
+    template<typename LineReader>
+    static table_sizes read_header(LineReader &lines) {
+        std::string header;
+        if (!lines.next(header)) {
+            throw std::runtime_error("Failed to read the header line");
+        }
+        table_sizes sizes;
+        auto header_begin = header.begin();
+        table_sizes_parser<std::string::iterator> sizes_parser;
+        bool r = boost::spirit::qi::phrase_parse(header_begin, header.end(), sizes_parser,
+                                                 boost::spirit::ascii::space, sizes);
+        if (!r || header_begin != header.end()) {
+            throw std::runtime_error("Failed to parse the header line");
+        }
+        return sizes;
+    }
+
+    static void check_first_row(const table_sizes &sizes, std::size_t first_row) {
+        if (first_row >= sizes.max_size) {
+            throw std::runtime_error("Row " + std::to_string(first_row) + " is past the end of the table of " +
+                                     std::to_string(sizes.max_size) + " rows");
+        }
+    }
+
+    template<typename LineReader>
+    std::shared_ptr<store_type> read_rows(LineReader &lines, const table_sizes &sizes, std::size_t first_row,
+                                          std::size_t rows_amount, const std::string &columns) const {
+        const std::size_t columns_amount =
+            sizes.witnesses_size + sizes.public_inputs_size + sizes.constants_size + sizes.selectors_size;
+        table_window window;
+        window.first_row = first_row;
+        window.rows_amount = rows_amount == 0 ? sizes.max_size - first_row
+                                              : std::min<std::size_t>(rows_amount, sizes.max_size - first_row);
+        if (!columns.empty()) {
+            std::vector<std::size_t> column_list;
+            if (!parse_column_names(columns, sizes, column_list)) {
+                throw std::runtime_error("Failed to parse the columns to load");
+            }
+            // Selectors decide where gates are applied, so they are always loaded.
+            window.columns.assign(columns_amount - sizes.selectors_size, false);
+            window.columns.resize(columns_amount, true);
+            for (std::size_t column : column_list) {
+                window.columns[column] = true;
+            }
+        }
+        table_sizes window_sizes = sizes;
+        window_sizes.max_size = window.rows_amount;
+        auto store = std::make_shared<store_type>(window_sizes);
+
+        // Row blocks are read as text a batch at a time, and the batch is parsed by all the threads.
+        const std::size_t blocks_amount = store->get_row_blocks_amount();
+        std::vector<std::string> texts(threads_amount);
+        std::vector<std::vector<cell_type>> values(threads_amount);
+        std::vector<std::string> errors(threads_amount);
+        std::string line;
+        for (std::size_t batch_begin = 0; batch_begin < blocks_amount; batch_begin += threads_amount) {
+            const std::size_t batch_size = std::min(threads_amount, blocks_amount - batch_begin);
+            for (std::size_t i = 0; i < batch_size; i++) {
+                texts[i].clear();
+                for (std::size_t row = 0; row < get_block_rows(window_sizes, batch_begin + i); row++) {
+                    if (!lines.next(line)) {
+                        throw std::runtime_error("The table file is shorter than its header says");
+                    }
+                    texts[i].append(line);
+                    texts[i].push_back('\n');
+                }
+            }
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < batch_size; i++) {
+                threads.emplace_back([&, i]() {
+                    const std::size_t block = batch_begin + i;
+                    errors[i].clear();
+                    try {
+                        parse_block(texts[i], window, columns_amount, first_row + block * block_rows,
+                                    get_block_rows(window_sizes, block), values[i]);
+                    } catch (const std::exception &e) {
+                        errors[i] = e.what();
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            for (std::size_t i = 0; i < batch_size; i++) {
+                if (!errors[i].empty()) {
+                    throw std::runtime_error(errors[i]);
+                }
+                store->fill_row_block(batch_begin + i, values[i]);
+            }
+        }
+        if (first_row == 0 && window.rows_amount == sizes.max_size && window.columns.empty()) {
+            window = table_window();
+        }
+        store->set_window(window);
+        return store;
+    }
+
+    static std::size_t get_block_rows(const table_sizes &sizes, std::size_t block) {
+        return std::min(block_rows, std::size_t(sizes.max_size) - block * block_rows);
+    }
+
+    // Parses the lines of a row block into row-major values, the columns which are not loaded are left zero.
+    static void parse_block(const std::string &text, const table_window &window, std::size_t columns_amount,
+                            std::size_t first_table_row, std::size_t rows, std::vector<cell_type> &values) {
+        auto hex_rule = boost::spirit::qi::uint_parser<parsed_type, 16, 1,
+                                                       (BlueprintFieldType::modulus_bits + 4 - 1) / 4>();
+        auto is_separator = [](char c) { return c == '|' || std::isspace(static_cast<unsigned char>(c)); };
+        values.assign(rows * columns_amount, store_type::zero());
+        const char* c = text.data();
+        const char* text_end = c + text.size();
+        for (std::size_t i = 0; i < rows; i++) {
+            const char* line_end = static_cast<const char*>(std::memchr(c, '\n', text_end - c));
+            std::size_t column = 0;
+            while (true) {
+                while (c != line_end && is_separator(*c)) {
+                    c++;
+                }
+                if (c == line_end) {
+                    break;
+                }
+                const char* token_end = c;
+                while (token_end != line_end && !is_separator(*token_end)) {
+                    token_end++;
+                }
+                if (column == columns_amount) {
+                    throw std::runtime_error("Row " + std::to_string(first_table_row + i) + " has too many values");
+                }
+                if (window.is_column_loaded(column)) {
+                    parsed_type value;
+                    const char* token_begin = c;
+                    if (!boost::spirit::qi::parse(token_begin, token_end, hex_rule, value) ||
+                            token_begin != token_end) {
+                        throw std::runtime_error("Failed to parse row " + std::to_string(first_table_row + i));
+                    }
+                    values[i * columns_amount + column] = traits::from_parsed(value);
+                }
+                column++;
+                c = token_end;
+            }
+            if (column != columns_amount) {
+                throw std::runtime_error("Row " + std::to_string(first_table_row + i) + " has too few values");
+            }
+            c = line_end + 1;
+        }
+    }
+
+    const std::size_t threads_amount;
+    const std::string index_directory;
+    bool index_reused;
+};